@@ -0,0 +1,350 @@
+/*
+  ==============================================================================
+
+    PolyAnalogClap.cpp
+    Created: 19 Oct 2026 3:58:30am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#include <clap/clap.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "PolyAnalogDSP.h"
+
+// Everything lives in the instance, the only globals are the const
+// descriptor/factory tables, so hosts can run many instances on many threads.
+class PolyAnalogClap {
+public:
+    PolyAnalogClap(const clap_host_t* host);
+
+public:
+    bool init();
+    bool activate(double sampleRate);
+    clap_process_status process(const clap_process_t* process);
+
+    void applyEvent(const clap_event_header_t* event);
+
+    bool saveState(const clap_ostream_t* stream);
+    bool loadState(const clap_istream_t* stream);
+
+    bool getParamInfo(uint32_t index, clap_param_info_t* info);
+    bool getParamValue(clap_id paramId, double* value);
+    void flushParams(const clap_input_events_t* in);
+
+private:
+    float getStateValue(int index);
+
+public:
+    clap_plugin_t plugin;
+
+private:
+    static constexpr uint32_t stateVersion = 1;
+    static constexpr uint8_t channelCount = 2;
+
+    const clap_host_t* host;
+    const clap_host_params_t* hostParams = nullptr;
+    PolyAnalogDSP dsp;
+
+    // Last state loaded, what the host sees until the engine has committed it
+    float loadedState[PolyAnalogDSP::Count];
+};
+
+static const char* features[] = {
+    CLAP_PLUGIN_FEATURE_INSTRUMENT,
+    CLAP_PLUGIN_FEATURE_SYNTHESIZER,
+    CLAP_PLUGIN_FEATURE_STEREO,
+    nullptr
+};
+
+static const clap_plugin_descriptor_t descriptor = {
+    CLAP_VERSION_INIT,
+    "com.ymnk.polyanalog",
+    "PolyAnalog",
+    "YMNK",
+    "https://github.com/alexiszbik/polyanalog",
+    "",
+    "",
+    "1.0.0",
+    "4-voice polyphonic analog synthesizer",
+    features
+};
+
+PolyAnalogClap::PolyAnalogClap(const clap_host_t* host) : host(host) {
+    plugin.desc = &descriptor;
+    plugin.plugin_data = this;
+}
+
+bool PolyAnalogClap::init() {
+    hostParams = static_cast<const clap_host_params_t*>(host->get_extension(host, CLAP_EXT_PARAMS));
+    return true;
+}
+
+bool PolyAnalogClap::activate(double sampleRate) {
+    dsp.init(channelCount, sampleRate);
+    return true;
+}
+
+void PolyAnalogClap::applyEvent(const clap_event_header_t* event) {
+    if (event->space_id != CLAP_CORE_EVENT_SPACE_ID) {
+        return;
+    }
+    switch (event->type) {
+        case CLAP_EVENT_NOTE_ON: {
+            auto note = reinterpret_cast<const clap_event_note_t*>(event);
+            dsp.processMIDI(kNoteOn, note->channel, note->key, (int)(note->velocity * 127.0));
+        }
+            break;
+        case CLAP_EVENT_NOTE_OFF: {
+            auto note = reinterpret_cast<const clap_event_note_t*>(event);
+            if (note->key < 0) { // Wildcard : every key
+                dsp.allNotesOff();
+            } else {
+                dsp.processMIDI(kNoteOff, note->channel, note->key, 0);
+            }
+        }
+            break;
+        case CLAP_EVENT_PARAM_VALUE: {
+            auto param = reinterpret_cast<const clap_event_param_value_t*>(event);
+            if (param->param_id < PolyAnalogDSP::Count) {
+                dsp.setParameterValue(param->param_id, (float)param->value);
+            }
+        }
+            break;
+        case CLAP_EVENT_MIDI: {
+            auto midi = reinterpret_cast<const clap_event_midi_t*>(event);
+            const uint8_t status = midi->data[0] & 0xF0;
+            const int channel = midi->data[0] & 0x0F;
+            switch (status) {
+                case 0x80: dsp.processMIDI(kNoteOff, channel, midi->data[1], 0); break;
+                case 0x90:
+                    if (midi->data[2] == 0) {
+                        dsp.processMIDI(kNoteOff, channel, midi->data[1], 0);
+                    } else {
+                        dsp.processMIDI(kNoteOn, channel, midi->data[1], midi->data[2]);
+                    }
+                    break;
+                case 0xB0: dsp.processMIDI(kControlChange, channel, midi->data[1], midi->data[2]); break;
+                case 0xE0: dsp.processMIDI(kPitchBend, channel, midi->data[1] | (midi->data[2] << 7), 0); break;
+                case 0xF0:
+                    if (midi->data[0] >= 0xF8) {
+                        dsp.processMIDIRealtime(midi->data[0]);
+                    }
+                    break;
+                default: break;
+            }
+        }
+            break;
+        default:
+            break;
+    }
+}
+
+// Sample accurate : the block is split at every event timestamp
+clap_process_status PolyAnalogClap::process(const clap_process_t* process) {
+    if (process->audio_outputs_count == 0 || process->audio_outputs[0].channel_count < channelCount) {
+        return CLAP_PROCESS_ERROR;
+    }
+    float** out = process->audio_outputs[0].data32;
+    const uint32_t frameCount = process->frames_count;
+    const uint32_t eventCount = process->in_events->size(process->in_events);
+
+    uint32_t frame = 0;
+    uint32_t eventIndex = 0;
+    while (frame < frameCount) {
+        uint32_t nextEventFrame = frameCount;
+        while (eventIndex < eventCount) {
+            auto event = process->in_events->get(process->in_events, eventIndex);
+            if (event->time > frame) {
+                nextEventFrame = event->time < frameCount ? event->time : frameCount;
+                break;
+            }
+            applyEvent(event);
+            eventIndex++;
+        }
+
+        float* segment[channelCount] = { out[0] + frame, out[1] + frame };
+        dsp.process(segment, nextEventFrame - frame);
+        frame = nextEventFrame;
+    }
+    return CLAP_PROCESS_CONTINUE;
+}
+
+// A loaded state reads back as loaded, even before the engine has committed it
+float PolyAnalogClap::getStateValue(int index) {
+    return dsp.hasStagedPreset() ? loadedState[index] : dsp.getParameter(index)->getUIValue();
+}
+
+bool PolyAnalogClap::saveState(const clap_ostream_t* stream) {
+    float values[PolyAnalogDSP::Count];
+    for (int i = 0; i < PolyAnalogDSP::Count; i++) {
+        values[i] = getStateValue(i);
+    }
+
+    const uint32_t header[2] = { stateVersion, (uint32_t)PolyAnalogDSP::Count };
+    return stream->write(stream, header, sizeof(header)) == sizeof(header)
+        && stream->write(stream, values, sizeof(values)) == sizeof(values);
+}
+
+bool PolyAnalogClap::loadState(const clap_istream_t* stream) {
+    uint32_t header[2];
+    if (stream->read(stream, header, sizeof(header)) != sizeof(header) || header[0] != stateVersion) {
+        return false;
+    }
+
+    // Parameters are only ever appended, an older state keeps the current tail
+    float values[PolyAnalogDSP::Count];
+    for (int i = 0; i < PolyAnalogDSP::Count; i++) {
+        values[i] = getStateValue(i);
+    }
+    const uint32_t count = header[1] < PolyAnalogDSP::Count ? header[1] : PolyAnalogDSP::Count;
+    const int64_t size = count * sizeof(float);
+    if (stream->read(stream, values, size) != size) {
+        return false;
+    }
+    for (int i = 0; i < PolyAnalogDSP::Count; i++) {
+        loadedState[i] = values[i];
+    }
+    dsp.stagePreset(values);
+    
+    if (hostParams) {
+        hostParams->rescan(host, CLAP_PARAM_RESCAN_VALUES);
+    }
+    return true;
+}
+
+bool PolyAnalogClap::getParamInfo(uint32_t index, clap_param_info_t* info) {
+    if (index >= PolyAnalogDSP::Count) {
+        return false;
+    }
+    memset(info, 0, sizeof(clap_param_info_t));
+    info->id = index;
+    info->flags = CLAP_PARAM_IS_AUTOMATABLE;
+    info->min_value = 0.0;
+    info->max_value = 1.0;
+    info->default_value = parameterDefault(index);
+    snprintf(info->name, sizeof(info->name), "%s", dsp.getParameter(index)->getName());
+    return true;
+}
+
+bool PolyAnalogClap::getParamValue(clap_id paramId, double* value) {
+    if (paramId >= PolyAnalogDSP::Count) {
+        return false;
+    }
+    *value = getStateValue(paramId);
+    return true;
+}
+
+void PolyAnalogClap::flushParams(const clap_input_events_t* in) {
+    const uint32_t eventCount = in->size(in);
+    for (uint32_t k = 0; k < eventCount; k++) {
+        applyEvent(in->get(in, k));
+    }
+}
+
+//==============================================================================
+static PolyAnalogClap* self(const clap_plugin_t* plugin) {
+    return static_cast<PolyAnalogClap*>(plugin->plugin_data);
+}
+
+static const clap_plugin_params_t paramsExtension = {
+    [](const clap_plugin_t*) -> uint32_t { return PolyAnalogDSP::Count; },
+    [](const clap_plugin_t* p, uint32_t index, clap_param_info_t* info) { return self(p)->getParamInfo(index, info); },
+    [](const clap_plugin_t* p, clap_id paramId, double* value) { return self(p)->getParamValue(paramId, value); },
+    [](const clap_plugin_t*, clap_id, double value, char* display, uint32_t size) {
+        snprintf(display, size, "%.3f", value);
+        return true;
+    },
+    [](const clap_plugin_t*, clap_id, const char* display, double* value) {
+        return sscanf(display, "%lf", value) == 1;
+    },
+    [](const clap_plugin_t* p, const clap_input_events_t* in, const clap_output_events_t*) { self(p)->flushParams(in); }
+};
+
+static const clap_plugin_state_t stateExtension = {
+    [](const clap_plugin_t* p, const clap_ostream_t* stream) { return self(p)->saveState(stream); },
+    [](const clap_plugin_t* p, const clap_istream_t* stream) { return self(p)->loadState(stream); }
+};
+
+static const clap_plugin_audio_ports_t audioPortsExtension = {
+    [](const clap_plugin_t*, bool isInput) -> uint32_t { return isInput ? 0 : 1; },
+    [](const clap_plugin_t*, uint32_t index, bool isInput, clap_audio_port_info_t* info) {
+        if (isInput || index > 0) {
+            return false;
+        }
+        info->id = 0;
+        snprintf(info->name, sizeof(info->name), "Output");
+        info->flags = CLAP_AUDIO_PORT_IS_MAIN;
+        info->channel_count = 2;
+        info->port_type = CLAP_PORT_STEREO;
+        info->in_place_pair = CLAP_INVALID_ID;
+        return true;
+    }
+};
+
+static const clap_plugin_note_ports_t notePortsExtension = {
+    [](const clap_plugin_t*, bool isInput) -> uint32_t { return isInput ? 1 : 0; },
+    [](const clap_plugin_t*, uint32_t index, bool isInput, clap_note_port_info_t* info) {
+        if (!isInput || index > 0) {
+            return false;
+        }
+        info->id = 0;
+        info->supported_dialects = CLAP_NOTE_DIALECT_CLAP | CLAP_NOTE_DIALECT_MIDI;
+        info->preferred_dialect = CLAP_NOTE_DIALECT_CLAP;
+        snprintf(info->name, sizeof(info->name), "MIDI In");
+        return true;
+    }
+};
+
+static const clap_plugin_t* createPlugin(const clap_host_t* host) {
+    auto instance = new PolyAnalogClap(host);
+    clap_plugin_t& plugin = instance->plugin;
+
+    plugin.init = [](const clap_plugin_t* p) { return self(p)->init(); };
+    plugin.destroy = [](const clap_plugin_t* p) { delete self(p); };
+    plugin.activate = [](const clap_plugin_t* p, double sampleRate, uint32_t, uint32_t) {
+        return self(p)->activate(sampleRate);
+    };
+    plugin.deactivate = [](const clap_plugin_t*) {};
+    plugin.start_processing = [](const clap_plugin_t*) { return true; };
+    plugin.stop_processing = [](const clap_plugin_t*) {};
+    plugin.reset = [](const clap_plugin_t*) {};
+    plugin.process = [](const clap_plugin_t* p, const clap_process_t* process) {
+        return self(p)->process(process);
+    };
+    plugin.get_extension = [](const clap_plugin_t*, const char* id) -> const void* {
+        if (!strcmp(id, CLAP_EXT_PARAMS)) return &paramsExtension;
+        if (!strcmp(id, CLAP_EXT_STATE)) return &stateExtension;
+        if (!strcmp(id, CLAP_EXT_AUDIO_PORTS)) return &audioPortsExtension;
+        if (!strcmp(id, CLAP_EXT_NOTE_PORTS)) return &notePortsExtension;
+        return nullptr;
+    };
+    plugin.on_main_thread = [](const clap_plugin_t*) {};
+
+    return &plugin;
+}
+
+static const clap_plugin_factory_t factory = {
+    [](const clap_plugin_factory_t*) -> uint32_t { return 1; },
+    [](const clap_plugin_factory_t*, uint32_t index) -> const clap_plugin_descriptor_t* {
+        return index == 0 ? &descriptor : nullptr;
+    },
+    [](const clap_plugin_factory_t*, const clap_host_t* host, const char* pluginId) -> const clap_plugin_t* {
+        if (!clap_version_is_compatible(host->clap_version) || strcmp(pluginId, descriptor.id)) {
+            return nullptr;
+        }
+        return createPlugin(host);
+    }
+};
+
+extern "C" CLAP_EXPORT const clap_plugin_entry_t clap_entry = {
+    CLAP_VERSION_INIT,
+    [](const char*) { return true; },
+    []() {},
+    [](const char* factoryId) -> const void* {
+        return !strcmp(factoryId, CLAP_PLUGIN_FACTORY_ID) ? &factory : nullptr;
+    }
+};
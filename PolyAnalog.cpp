@@ -9,6 +9,15 @@ using namespace daisy;
 using namespace daisysp;
 using namespace ydaisy;
 
+// Low latency trades CPU for MIDI-to-audio latency, any size from 1 to 256+ works
+#define LOW_LATENCY 0
+
+#if LOW_LATENCY
+#define AUDIO_BLOCK_SIZE 4
+#else
+#define AUDIO_BLOCK_SIZE 48
+#endif
+
 DaisySeed hw;
 PolyAnalogCore polyAnalog;
 DaisyBase db = DaisyBase(&hw, &polyAnalog);
@@ -16,45 +25,120 @@ DaisyBase db = DaisyBase(&hw, &polyAnalog);
 PresetManager pm;
 DisplayManager *display = DisplayManager::GetInstance();
 
+#define TRACE_DUMP_LINES 8 // Per main loop iteration, the serial prints block
+
+TraceEvent traceDump[TRACE_EVENT_COUNT];
+uint32_t dumpedOverruns = 0;
+size_t traceDumpCount = 0;
+size_t traceDumpSent = 0;
+bool traceDumping = false;
+
+// Chorus and delay lines, too big for the internal RAM
+float DSY_SDRAM_BSS effectsMemory[EFFECTS_MEMORY_SIZE];
+
+// Boot stages, System::GetUs() stamps (us since System::Init, so the hardware
+// init is included), printed once the knobs have settled
+struct BootTimes {
+    uint32_t audio = 0;
+    uint32_t preset = 0;
+    volatile uint32_t firstSound = 0; // First block rendered with the boot preset
+    uint32_t display = 0;
+    uint32_t hid = 0;
+};
+BootTimes boot;
+volatile bool bootPresetStaged = false;
+
 void AudioCallback(AudioHandle::InputBuffer in, AudioHandle::OutputBuffer out, size_t size)
 {
     db.process(out, size);
+    if (boot.firstSound == 0 && bootPresetStaged && !polyAnalog.hasStagedPreset()) {
+        boot.firstSound = System::GetUs();
+    }
 }
 
-void InitHID()
-{
-    db.listen();
+// Sends the event trace over USB serial after an audio overrun, decode it with Tools/TraceDecode
+void DumpTraceOnOverrun() {
+    if (traceDumping) {
+        return;
+    }
+    EventTrace& trace = polyAnalog.getTrace();
+    uint32_t overruns = trace.getOverrunCount();
+    if (overruns == dumpedOverruns) {
+        return;
+    }
+    dumpedOverruns = overruns;
+    
+    traceDumpCount = trace.snapshot(traceDump, TRACE_EVENT_COUNT);
+    traceDumpSent = 0;
+    traceDumping = true;
+    hw.PrintLine("TRACE BEGIN %u", (unsigned)traceDumpCount);
 }
 
-void UpdateValues() {
-    polyAnalog.displayValuesOnScreen();
+// A few lines per main loop iteration, the controls and the display keep up
+void ContinueTraceDump() {
+    if (!traceDumping) {
+        return;
+    }
+    for (int k = 0; k < TRACE_DUMP_LINES && traceDumpSent < traceDumpCount; k++) {
+        const TraceEvent& e = traceDump[traceDumpSent++];
+        hw.PrintLine("%08lx%02x%02x%04x", (unsigned long)e.time, e.type, e.a, e.b);
+    }
+    if (traceDumpSent == traceDumpCount) {
+        hw.PrintLine("TRACE END");
+        traceDumping = false;
+    }
+}
+
+void PrintBootTimes() {
+    hw.PrintLine("BOOT us since System::Init : audio %lu, preset %lu, first sound %lu, display %lu, knobs settled %lu",
+                 (unsigned long)boot.audio, (unsigned long)boot.preset, (unsigned long)boot.firstSound,
+                 (unsigned long)boot.display, (unsigned long)boot.hid);
 }
 
+// Staged boot : sound first, then the screen, the knobs settle in the main loop
 int main(void)
 {
+    polyAnalog.setEffectsMemory(effectsMemory, EFFECTS_MEMORY_SIZE);
     db.init(AudioCallback);
+    hw.StopAudio();
+    hw.SetAudioBlockSize(AUDIO_BLOCK_SIZE);
+    hw.StartAudio(AudioCallback);
+    polyAnalog.getTrace().setClock(System::GetUs);
+    boot.audio = System::GetUs();
 
-    display->Init(&hw);
-    display->WriteNow("YMNK", "PolyAnalog Synth");
-
+    // Presets are memory mapped QSPI reads, the boot one is committed by the next audio block
     pm.Init(&hw);
+    db.setPresetManager(&pm);
+    polyAnalog.initPresets(&hw.qspi);
+    polyAnalog.loadBootPreset();
+    bootPresetStaged = true;
+    boot.preset = System::GetUs();
+
+    // The knobs are read from here on but only applied once they hold still
+    polyAnalog.beginHIDSettle(System::GetNow());
 
+    hw.StartLog(false);
+    display->Init(&hw);
+    display->WriteNow("YMNK", "PolyAnalog Synth");
     db.setDisplayManager(display);
-    db.setPresetManager(&pm);
+    boot.display = System::GetUs();
 
     //polyFM.setHIDValue(PolyFMCore::MidiLed, 1);
 
-    BlockingAction blocker;
-    blocker.Run(1000, InitHID); //Wait for HID to init
-    //Is it the best solution ? Maybe ?
-
-    EveryMs displayValuesUpdater (125, UpdateValues);
+    EveryMs traceDumper (1000, DumpTraceOnOverrun);
 
     for(;;)
     {
+        polyAnalog.updateControls(System::GetNow());
         db.listen();
-        displayValuesUpdater.Update();
-        display->Update();
+        if (polyAnalog.updateHIDSettle(System::GetNow())) {
+            boot.hid = System::GetUs();
+            PrintBootTimes();
+        }
+        traceDumper.Update();
+        ContinueTraceDump();
+        polyAnalog.processPresetWrites();
+        polyAnalog.updateDisplay(System::GetNow()); // Draws only what changed, see DisplayModel.h
     }
     
 }
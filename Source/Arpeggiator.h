@@ -0,0 +1,410 @@
+/*
+  ==============================================================================
+
+    Arpeggiator.h
+    Created: 19 Oct 2026 4:27:54am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <climits>
+
+#define ARP_MAX_NOTES 16
+#define ARP_MAX_OCTAVES 4
+#define SEQ_STEP_COUNT 16
+#define MIDI_CLOCK_PPQN 24
+#define ARP_DEFAULT_TEMPO 120.f // BPM
+#define ARP_DEFAULT_GATE 0.5f
+
+// Only the host builds (plugin, tools) receive MIDI clock, the firmware
+// offers the internal clock alone
+#ifndef ARP_MIDI_CLOCK
+#define ARP_MIDI_CLOCK 0
+#endif
+
+// Arpeggiator and step sequencer in front of the synth. The held keys are
+// collected here, the generated notes come back through the output given to
+// fireDueEvents. Timing is counted in frames : the caller splits its audio
+// block on framesUntilEvent so every note lands on its exact frame.
+//
+// Clock_Internal follows setTempo. Clock_Midi steps on the 24 ppqn MIDI
+// clock, the pulse period only sizes the gate (ARP_MIDI_CLOCK builds).
+class Arpeggiator {
+public:
+    enum Mode {
+        Mode_Off = 0,
+        Mode_Up,
+        Mode_Down,
+        Mode_UpDown,
+        Mode_Random,
+        Mode_AsPlayed,
+        Mode_Sequencer, // Recorded steps, transposed by the lowest held key
+
+        Mode_Count
+    };
+
+    enum Division {
+        Division_Quarter = 0,
+        Division_8th,
+        Division_8thTriplet,
+        Division_16th,
+        Division_16thTriplet,
+        Division_32nd,
+
+        Division_Count
+    };
+
+    enum ClockSource {
+        Clock_Internal = 0,
+        Clock_Midi,
+
+        Clock_Count
+    };
+    static constexpr int clockSourceCount = ARP_MIDI_CLOCK ? Clock_Count : Clock_Midi; // Selectable
+
+public:
+    void init(float sampleRate) {
+        this->sampleRate = sampleRate;
+        pulseFrames = sampleRate * 60.f / (tempo * MIDI_CLOCK_PPQN);
+        updateStepFrames();
+    }
+
+    void setMode(Mode mode) {
+        if (mode != this->mode) {
+            this->mode = mode;
+            resetPending = true;
+        }
+    }
+
+    void setOctaves(int octaves) {
+        this->octaves = octaves;
+    }
+
+    void setDivision(Division division) {
+        this->division = division;
+        updateStepFrames();
+    }
+
+    // 0..1 of a step
+    void setGate(float gate) {
+        this->gate = gate;
+    }
+
+    void setTempo(float bpm) {
+        tempo = bpm;
+        updateStepFrames();
+    }
+
+    void setClockSource(ClockSource source) {
+        clockSource = source;
+        updateStepFrames();
+        framesToStep = fminf(framesToStep, stepFrames);
+    }
+
+    // While recording the keys pass through and each note on appends a step
+    void setRecord(bool record) {
+        if (record && !recording) {
+            recordedCount = 0;
+        }
+        recording = record;
+    }
+
+    inline bool isActive() const noexcept {
+        return mode != Mode_Off;
+    }
+
+    //==============================================================================
+    // Keys, false when the caller should play the note itself
+
+    bool noteOn(int pitch, int velocity) {
+        if (mode == Mode_Off) {
+            return false;
+        }
+        if (mode == Mode_Sequencer && recording) {
+            recordStep(pitch);
+            return false;
+        }
+        if (heldCount == ARP_MAX_NOTES) {
+            return true;
+        }
+        removeHeld(pitch);
+        if (heldCount == 0) {
+            position = 0;
+            if (clockSource == Clock_Internal) {
+                framesToStep = 0.f; // Start on the key, not on the next tick
+            }
+        }
+        held[heldCount].pitch = (uint8_t)pitch;
+        held[heldCount].velocity = (uint8_t)velocity;
+        heldCount++;
+        updateSorted();
+        return true;
+    }
+
+    // Keys pressed before the arpeggiator was turned on are not ours
+    bool noteOff(int pitch) {
+        if (mode == Mode_Off || !removeHeld(pitch)) {
+            return false;
+        }
+        updateSorted();
+        return true;
+    }
+
+    // Every key up, the sounding note is released at the next event
+    void releaseAll() {
+        heldCount = 0;
+        framesToRelease = 0.f;
+    }
+
+    //==============================================================================
+    // MIDI real time messages (0xF8 clock, 0xFA start, 0xFB continue, 0xFC stop)
+
+    void processRealtime(uint8_t status) {
+        switch (status) {
+            case 0xF8 :
+                if (framesSincePulse < sampleRate) { // Not the first pulse after a pause
+                    pulseFrames += (framesSincePulse - pulseFrames) * 0.25f;
+                    updateStepFrames();
+                }
+                framesSincePulse = 0.f;
+                if (clockRunning) {
+                    if (pulseIndex % pulsesPerStep(division) == 0 && clockSource == Clock_Midi) {
+                        framesToStep = 0.f;
+                    }
+                    pulseIndex++;
+                }
+                break;
+            case 0xFA :
+                pulseIndex = 0;
+                position = 0;
+                clockRunning = true;
+                break;
+            case 0xFB :
+                clockRunning = true;
+                break;
+            case 0xFC :
+                clockRunning = false;
+                if (clockSource == Clock_Midi) {
+                    framesToRelease = 0.f;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    //==============================================================================
+    // Audio thread
+
+    // Frames before the next note event, INT_MAX when idle
+    int framesUntilEvent() const noexcept {
+        if (mode == Mode_Off) {
+            return INT_MAX;
+        }
+        float next = soundingPitch >= 0 ? framesToRelease : INFINITY;
+        if (heldCount > 0 && clockSource == Clock_Internal) {
+            next = fminf(next, framesToStep);
+        }
+        return next < (float)INT_MAX ? (int)ceilf(next) : INT_MAX;
+    }
+
+    void advance(int frameCount) {
+        framesSincePulse += frameCount;
+        if (mode == Mode_Off) {
+            return;
+        }
+        if (soundingPitch >= 0) {
+            framesToRelease -= frameCount;
+        }
+        if (clockSource == Clock_Internal && heldCount > 0) {
+            framesToStep -= frameCount;
+        }
+    }
+
+    // output(bool isNoteOn, int pitch, int velocity), at the current frame
+    template <typename Output>
+    void fireDueEvents(Output&& output) {
+        if (resetPending) {
+            resetPending = false;
+            if (mode == Mode_Off) {
+                heldCount = 0;
+            }
+            position = 0;
+            framesToRelease = 0.f;
+        }
+        if (soundingPitch >= 0 && framesToRelease <= 0.f) {
+            output(false, soundingPitch, 0);
+            soundingPitch = -1;
+        }
+        if (mode == Mode_Off || framesToStep > 0.f) {
+            return;
+        }
+
+        if (clockSource == Clock_Internal) {
+            framesToStep += stepFrames;
+        } else {
+            framesToStep = INFINITY; // Until the next step pulse
+        }
+        if (heldCount == 0) {
+            return;
+        }
+        int pitch, velocity;
+        if (!nextNote(pitch, velocity)) {
+            return;
+        }
+        if (soundingPitch >= 0) {
+            output(false, soundingPitch, 0);
+        }
+        output(true, pitch, velocity);
+        soundingPitch = pitch;
+        framesToRelease = fmaxf(gate * stepFrames, 1.f);
+    }
+
+private:
+    struct HeldNote {
+        uint8_t pitch;
+        uint8_t velocity;
+    };
+
+    struct Step {
+        int8_t offset;  // Semitones from the lowest held key
+    };
+
+    bool removeHeld(int pitch) {
+        for (int i = 0; i < heldCount; i++) {
+            if (held[i].pitch == pitch) {
+                for (int j = i + 1; j < heldCount; j++) {
+                    held[j - 1] = held[j];
+                }
+                heldCount--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Insertion sort, a handful of keys at most
+    void updateSorted() {
+        for (int i = 0; i < heldCount; i++) {
+            HeldNote note = held[i];
+            int j = i;
+            for (; j > 0 && sorted[j - 1].pitch > note.pitch; j--) {
+                sorted[j] = sorted[j - 1];
+            }
+            sorted[j] = note;
+        }
+    }
+
+    void recordStep(int pitch) {
+        if (recordedCount == 0) {
+            recordRoot = pitch;
+        }
+        if (recordedCount < SEQ_STEP_COUNT) {
+            const int offset = pitch - recordRoot;
+            steps[recordedCount].offset = (int8_t)(offset < -48 ? -48 : (offset > 48 ? 48 : offset));
+            recordedCount++;
+            stepCount = recordedCount;
+        }
+    }
+
+    bool nextNote(int& pitch, int& velocity) {
+        const int length = heldCount * octaves;
+        int index = position;
+        const HeldNote* notes = sorted;
+        switch (mode) {
+            case Mode_Up :
+                index = position % length;
+                break;
+            case Mode_Down :
+                index = length - 1 - position % length;
+                break;
+            case Mode_UpDown : {
+                const int period = length > 1 ? 2 * length - 2 : 1;
+                index = position % period;
+                if (index >= length) {
+                    index = period - index;
+                }
+            }
+                break;
+            case Mode_Random :
+                randomSeed = randomSeed * 1664525u + 1013904223u;
+                index = (int)((randomSeed >> 8) % (uint32_t)length);
+                break;
+            case Mode_AsPlayed :
+                index = position % length;
+                notes = held;
+                break;
+            case Mode_Sequencer : {
+                if (stepCount == 0) {
+                    return false;
+                }
+                const Step& step = steps[position % stepCount];
+                position++;
+                pitch = sorted[0].pitch + step.offset;
+                velocity = sorted[0].velocity;
+                return pitch >= 0 && pitch < 128;
+            }
+            default:
+                return false;
+        }
+        position++;
+        const HeldNote& note = notes[index % heldCount];
+        pitch = note.pitch + 12 * (index / heldCount);
+        velocity = note.velocity;
+        return pitch < 128;
+    }
+
+    void updateStepFrames() {
+        static const float beats[Division_Count] = { 1.f, 0.5f, 1.f / 3.f, 0.25f, 1.f / 6.f, 0.125f };
+        if (clockSource == Clock_Midi) {
+            stepFrames = pulseFrames * pulsesPerStep(division);
+        } else {
+            stepFrames = beats[division] * 60.f / tempo * sampleRate;
+        }
+    }
+
+    static uint32_t pulsesPerStep(Division division) {
+        static const uint32_t pulses[Division_Count] = { 24, 12, 8, 6, 4, 3 };
+        return pulses[division];
+    }
+
+private:
+    float sampleRate = 48000.f;
+
+    Mode mode = Mode_Off;
+    Division division = Division_8th;
+    ClockSource clockSource = Clock_Internal;
+    int octaves = 1;
+    float gate = ARP_DEFAULT_GATE;
+    float tempo = ARP_DEFAULT_TEMPO;
+    bool resetPending = false;
+
+    HeldNote held[ARP_MAX_NOTES];    // In played order
+    HeldNote sorted[ARP_MAX_NOTES];  // By pitch
+    int heldCount = 0;
+    int position = 0;
+    uint32_t randomSeed = 1;
+
+    Step steps[SEQ_STEP_COUNT] = { {0}, {0}, {12}, {0}, {7}, {0}, {10}, {12} };
+    int stepCount = 8;
+    int recordedCount = 0;
+    int recordRoot = 0;
+    bool recording = false;
+
+    // Timing, in frames
+    float stepFrames = 12000.f;
+    float framesToStep = 0.f;
+    float framesToRelease = 0.f;
+    int soundingPitch = -1;
+
+    // MIDI clock
+    bool clockRunning = true;
+    uint32_t pulseIndex = 0;
+    float pulseFrames = 1000.f;
+    float framesSincePulse = 0.f;
+};
@@ -0,0 +1,17 @@
+/*
+  ==============================================================================
+
+    BlockSize.h
+    Created: 19 Oct 2026 4:07:36am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Any audio block size works, from 1 frame up. Blocks bigger than this are
+// rendered in MAX_BLOCK_SIZE chunks, it only sizes the internal buffers.
+#ifndef MAX_BLOCK_SIZE
+#define MAX_BLOCK_SIZE 128
+#endif
@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    Chorus.h
+    Created: 19 Oct 2026 4:24:27am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "DelayLine.h"
+#include "BlockSize.h"
+
+#define CHORUS_MAX_SECONDS 0.05f
+#define CHORUS_DEFAULT_RATE 0.5f // Hz
+#define CHORUS_DEFAULT_DEPTH 0.5f
+
+// Bucket brigade style : one triangle LFO sweeping two short delays in
+// opposite directions (left / right), a darkened wet signal.
+class Chorus {
+public:
+    void init(float sampleRate, float* memory, size_t lineLength) {
+        this->sampleRate = sampleRate;
+        lines[0].init(memory, lineLength);
+        lines[1].init(memory + lineLength, lineLength);
+        damping = 1.f - expf(-2.f * (float)M_PI * 7000.f / sampleRate);
+        setRate(CHORUS_DEFAULT_RATE);
+        setDepth(CHORUS_DEFAULT_DEPTH);
+    }
+
+    // 0 turns the chorus off, the next process calls then cost nothing
+    void setMix(float mix) {
+        if (mix > 0.f && targetMix == 0.f && currentMix == 0.f) {
+            lines[0].reset();
+            lines[1].reset();
+        }
+        targetMix = mix;
+    }
+
+    void setRate(float hz) {
+        phaseIncrement = 4.f * hz / sampleRate; // Triangle goes -1..1..-1 in 4 quarters
+    }
+
+    // 0..1, up to 4 ms of sweep around a 7 ms delay
+    void setDepth(float depth) {
+        sweep = depth * 0.004f * sampleRate;
+    }
+
+    inline bool isActive() const noexcept {
+        return targetMix > 0.f || currentMix > 0.f;
+    }
+
+    void process(float* left, float* right, size_t frameCount) {
+        if (!isActive()) {
+            return;
+        }
+        const float mixFrom = currentMix;
+        currentMix = targetMix;
+        const float mixStep = (currentMix - mixFrom) / frameCount;
+
+        const float center = fmaxf(0.007f * sampleRate, sweep + frameCount + 1.f);
+        float* channels[2] = { left, right };
+        for (int channel = 0; channel < 2; channel++) {
+            float* buf = channels[channel];
+            float p = phase;
+            float lp = lowpass[channel];
+            const float direction = channel == 0 ? 1.f : -1.f;
+            for (size_t i = 0; i < frameCount; i++) {
+                p += phaseIncrement;
+                if (p > 1.f) {
+                    p -= 4.f;
+                }
+                const float triangle = p < -1.f ? -2.f - p : p;
+                lp += damping * (lines[channel].read(i, center + sweep * triangle * direction) - lp);
+                wet[i] = lp;
+            }
+            lowpass[channel] = lp;
+            lines[channel].write(buf, frameCount);
+
+            for (size_t i = 0; i < frameCount; i++) {
+                const float mix = (mixFrom + mixStep * (i + 1)) * 0.5f;
+                buf[i] += (wet[i] - buf[i]) * mix;
+            }
+        }
+        phase += phaseIncrement * frameCount;
+        while (phase > 1.f) {
+            phase -= 4.f;
+        }
+    }
+
+private:
+    DelayLine lines[2];
+    float wet[MAX_BLOCK_SIZE];
+    float lowpass[2] = { 0.f, 0.f };
+
+    float sampleRate = 48000.f;
+    float phase = -1.f;
+    float phaseIncrement = 0.f;
+    float sweep = 0.f;
+    float damping = 1.f;
+    float targetMix = 0.f;
+    float currentMix = 0.f;
+};
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    ControlMap.h
+    Created: 19 Oct 2026 4:14:36am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#define CONTROL_UNMAPPED 0xFF
+
+// MIDI controllers to parameters. A controller below 32 can be flagged high
+// resolution, its LSB then comes on controller + 32. Every parameter is
+// also reachable through NRPN, the NRPN number being the parameter index.
+class ControlMap {
+public:
+    // Unmaps every controller, NRPN reaches parameters below parameterCount
+    void clear(int parameterCount) {
+        this->parameterCount = parameterCount;
+        for (int cc = 0; cc < controllerCount; cc++) {
+            parameters[cc] = CONTROL_UNMAPPED;
+            highResolution[cc] = false;
+        }
+    }
+
+    void map(uint8_t cc, uint8_t parameter, bool highRes = false) {
+        if (cc < controllerCount && !isReserved(cc)) {
+            parameters[cc] = parameter;
+            highResolution[cc] = highRes && cc < lsbOffset;
+        }
+    }
+
+    void unmap(uint8_t cc) {
+        if (cc < controllerCount) {
+            parameters[cc] = CONTROL_UNMAPPED;
+            highResolution[cc] = false;
+        }
+    }
+
+    inline int getParameter(uint8_t cc) const noexcept {
+        return cc < controllerCount ? parameters[cc] : CONTROL_UNMAPPED;
+    }
+
+    // Returns true when the message sets a parameter, value is normalized
+    bool process(uint8_t cc, uint8_t data, int& parameter, float& value) {
+        switch (cc) {
+            case nrpnMsb:
+                nrpn = (data << 7) | (nrpn & 0x7F);
+                nrpnSelected = true;
+                return false;
+            case nrpnLsb:
+                nrpn = (nrpn & 0x3F80) | data;
+                nrpnSelected = true;
+                return false;
+            case rpnMsb:
+            case rpnLsb:
+                nrpnSelected = false; // Data entry now belongs to an RPN
+                return false;
+            case dataEntryMsb:
+                if (!nrpnSelected || nrpn >= parameterCount) {
+                    return false;
+                }
+                dataMsb = data;
+                parameter = nrpn;
+                value = (data << 7) * highResScale;
+                return true;
+            case dataEntryLsb:
+                if (!nrpnSelected || nrpn >= parameterCount) {
+                    return false;
+                }
+                parameter = nrpn;
+                value = ((dataMsb << 7) | data) * highResScale;
+                return true;
+            default:
+                break;
+        }
+        if (cc >= controllerCount) {
+            return false;
+        }
+
+        // LSB of a high resolution pair, unless the controller is mapped itself
+        if (parameters[cc] == CONTROL_UNMAPPED && cc >= lsbOffset && cc < 2 * lsbOffset) {
+            const uint8_t msbController = cc - lsbOffset;
+            if (!highResolution[msbController] || parameters[msbController] == CONTROL_UNMAPPED) {
+                return false;
+            }
+            parameter = parameters[msbController];
+            value = ((msbValues[msbController] << 7) | data) * highResScale;
+            return true;
+        }
+
+        if (parameters[cc] == CONTROL_UNMAPPED) {
+            return false;
+        }
+        parameter = parameters[cc];
+        if (highResolution[cc]) {
+            msbValues[cc] = data; // The LSB usually follows, until then 7 bits
+            value = (data << 7) * highResScale;
+        } else {
+            value = data / 127.f;
+        }
+        return true;
+    }
+
+    // Bank select, mod wheel, data entry, sustain, (N)RPN, channel mode
+    static constexpr bool isReserved(int cc) {
+        return cc == 0 || cc == 1 || cc == dataEntryMsb || cc == dataEntryLsb
+            || cc == 64 || (cc >= 96 && cc <= rpnMsb) || cc >= 120;
+    }
+
+private:
+    static constexpr int controllerCount = 128;
+    static constexpr uint8_t lsbOffset = 32;
+    static constexpr float highResScale = 1.f / 16383.f;
+
+    static constexpr uint8_t dataEntryMsb = 6;
+    static constexpr uint8_t dataEntryLsb = 38;
+    static constexpr uint8_t nrpnLsb = 98;
+    static constexpr uint8_t nrpnMsb = 99;
+    static constexpr uint8_t rpnLsb = 100;
+    static constexpr uint8_t rpnMsb = 101;
+
+private:
+    uint8_t parameters[controllerCount];
+    bool highResolution[controllerCount];
+    uint8_t msbValues[lsbOffset] = {};
+    int parameterCount = 0;
+
+    uint16_t nrpn = 0x3FFF;
+    bool nrpnSelected = false;
+    uint8_t dataMsb = 0;
+};
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    DelayLine.h
+    Created: 19 Oct 2026 4:24:27am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Circular buffer over memory it doesn't own (SDRAM on the Daisy), the
+// length is a power of 2. A block is read before it's written, so delays
+// must be at least one block long.
+class DelayLine {
+public:
+    void init(float* memory, size_t length) {
+        buffer = memory;
+        mask = length - 1;
+        writeIndex = 0;
+        reset();
+    }
+
+    // Forgets the content in O(1) : anything older than the reset reads as silence
+    void reset() {
+        written = 0;
+    }
+
+    inline size_t getLength() const noexcept {
+        return mask + 1;
+    }
+
+    // delay in frames, relative to frame of the block about to be written
+    inline float read(size_t frame, float delay) const noexcept {
+        const float position = (float)(written + frame) - delay;
+        if (position < 0.f) {
+            return 0.f;
+        }
+        const size_t index = (size_t)position;
+        const float fraction = position - index;
+        const size_t base = writeIndex - written;
+        const float a = buffer[(base + index) & mask];
+        const float b = buffer[(base + index + 1) & mask];
+        return a + (b - a) * fraction;
+    }
+
+    void write(const float* in, size_t frameCount) {
+        for (size_t i = 0; i < frameCount; i++) {
+            buffer[(writeIndex + i) & mask] = in[i];
+        }
+        writeIndex += frameCount;
+        written = written + frameCount > mask ? mask + 1 : written + frameCount;
+    }
+
+    // Largest power of 2 not above frames
+    static size_t floorPowerOf2(size_t frames) {
+        size_t length = 1;
+        while (length * 2 <= frames) {
+            length *= 2;
+        }
+        return length;
+    }
+
+private:
+    float* buffer = nullptr;
+    size_t mask = 0;
+    size_t writeIndex = 0;
+    size_t written = 0;
+};
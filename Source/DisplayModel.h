@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    DisplayModel.h
+    Created: 19 Oct 2026 4:29:27am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#define DISPLAY_LINE_COUNT 3
+#define DISPLAY_LINE_LENGTH 22  // 21 characters of the 6 px font on 128 px, plus the terminator
+#define DISPLAY_FRAME_MS 40     // At most 25 redraws per second
+
+// What the OLED should show, kept apart from the drawing. Controls post
+// cheap requests (a parameter moved, a message), the main loop composes
+// the text when a redraw is due and only the lines that changed are sent.
+// Nothing here allocates or touches floats.
+class DisplayModel {
+public:
+    // A parameter moved : it is composed at the next redraw, with its latest value
+    void postParameter(int index) {
+        pendingParameter = index;
+    }
+
+    // Takes the screen for holdMs, then the parameter view comes back
+    void postMessage(const char* title, const char* detail, uint32_t holdMs) {
+        setLine(1, title);
+        setLine(2, detail);
+        dirtyLines |= (1u << 1) | (1u << 2); // Same text again still flushes, the hold starts there
+        messageHoldMs = holdMs;
+        messageStarted = false;
+        if (pendingParameter < 0) {
+            pendingParameter = shownParameter;
+        }
+    }
+
+    // True when a redraw is due and the parameter view can be composed
+    bool takeParameter(uint32_t nowMs, int& index) {
+        if (pendingParameter < 0 || isHoldingMessage(nowMs)) {
+            return false;
+        }
+        index = pendingParameter;
+        shownParameter = pendingParameter;
+        pendingParameter = -1;
+        return true;
+    }
+
+    // Marks the line dirty only if the text changed
+    void setLine(int line, const char* text) {
+        if (strncmp(lines[line], text, DISPLAY_LINE_LENGTH - 1) == 0) {
+            return;
+        }
+        strncpy(lines[line], text, DISPLAY_LINE_LENGTH - 1);
+        lines[line][DISPLAY_LINE_LENGTH - 1] = '\0';
+        dirtyLines |= 1u << line;
+    }
+
+    inline bool isDue(uint32_t nowMs) const noexcept {
+        return nowMs - lastFrameMs >= DISPLAY_FRAME_MS;
+    }
+
+    // Sends the dirty lines and refreshes the screen, at most once per frame.
+    // False when there was nothing to draw.
+    template <typename Display>
+    bool flush(uint32_t nowMs, Display& display) {
+        if (dirtyLines == 0 || !isDue(nowMs)) {
+            return false;
+        }
+        for (int line = 0; line < DISPLAY_LINE_COUNT; line++) {
+            if (dirtyLines & (1u << line)) {
+                display.WriteLine(line, lines[line]);
+            }
+        }
+        dirtyLines = 0;
+        display.Update();
+        lastFrameMs = nowMs;
+        if (messageHoldMs > 0 && !messageStarted) {
+            messageStarted = true;
+            messageStartMs = nowMs;
+        }
+        return true;
+    }
+
+    //==============================================================================
+    // Integer formatting, each returns the end of the written text
+
+    static char* formatInt(int value, char* out) {
+        char digits[12];
+        int count = 0;
+        unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+        do {
+            digits[count++] = (char)('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (value < 0) {
+            *out++ = '-';
+        }
+        while (count > 0) {
+            *out++ = digits[--count];
+        }
+        *out = '\0';
+        return out;
+    }
+
+    // 42 -> "0.42", -105 -> "-1.05"
+    static char* formatHundredths(int hundredths, char* out) {
+        if (hundredths < 0) {
+            *out++ = '-';
+            hundredths = -hundredths;
+        }
+        out = formatInt(hundredths / 100, out);
+        const int fraction = hundredths % 100;
+        *out++ = '.';
+        *out++ = (char)('0' + fraction / 10);
+        *out++ = (char)('0' + fraction % 10);
+        *out = '\0';
+        return out;
+    }
+
+private:
+    bool isHoldingMessage(uint32_t nowMs) {
+        if (messageHoldMs == 0) {
+            return false;
+        }
+        if (!messageStarted || nowMs - messageStartMs < messageHoldMs) {
+            return true;
+        }
+        messageHoldMs = 0;
+        return false;
+    }
+
+private:
+    char lines[DISPLAY_LINE_COUNT][DISPLAY_LINE_LENGTH] = {};
+    uint32_t dirtyLines = 0;
+    uint32_t lastFrameMs = 0;
+
+    int pendingParameter = -1;
+    int shownParameter = -1;
+
+    uint32_t messageHoldMs = 0;
+    uint32_t messageStartMs = 0;
+    bool messageStarted = false;
+};
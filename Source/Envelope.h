@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    Envelope.h
+    Created: 19 Oct 2026 4:13:17am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+
+#include "BlockSize.h"
+
+// One exponential segment : level(k) = target + (start - target) * coef^k.
+// The powers of coef are tabulated so a block is filled without any
+// loop-carried dependency.
+struct EnvelopeSegment {
+    void setTime(float seconds, float sampleRate, float ratio) {
+        const float frames = fmaxf(seconds * sampleRate, 1.f);
+        coef = powf(ratio, 1.f / frames);
+        logCoef = logf(coef);
+        float power = 1.f;
+        for (int k = 0; k <= MAX_BLOCK_SIZE; k++) {
+            powers[k] = power;
+            power *= coef;
+        }
+    }
+
+    // Frames needed to go from distance to threshold, both relative to the target
+    inline int framesUntil(float distance, float threshold) const noexcept {
+        if (distance <= threshold) {
+            return 0;
+        }
+        if (coef <= 0.f) {
+            return 1;
+        }
+        return (int)ceilf(logf(threshold / distance) / logCoef);
+    }
+
+    float coef = 0.f;
+    float logCoef = 0.f;
+    float powers[MAX_BLOCK_SIZE + 1];
+};
+
+// Settings shared by every voice, recomputed only when a time changes.
+// setADSR may come from any thread (the main loop on the Daisy) : it only
+// posts the values, the segments are rebuilt by update() at the start of the
+// audio block, so render never reads a half written table.
+class EnvelopeShape {
+public:
+    void init(float sampleRate) {
+        this->sampleRate = sampleRate;
+        pending.store(false, std::memory_order_relaxed);
+        attackTime = requestedAttack.load(std::memory_order_relaxed);
+        decayTime = requestedDecay.load(std::memory_order_relaxed);
+        releaseTime = requestedRelease.load(std::memory_order_relaxed);
+        sustain = requestedSustain.load(std::memory_order_relaxed);
+        attackSegment.setTime(attackTime, sampleRate, (attackTarget - 1.f) / attackTarget);
+        decaySegment.setTime(decayTime, sampleRate, settleRatio);
+        releaseSegment.setTime(releaseTime, sampleRate, settleRatio);
+    }
+
+    void setADSR(float attack, float decay, float sustain, float release) {
+        requestedAttack.store(attack, std::memory_order_relaxed);
+        requestedDecay.store(decay, std::memory_order_relaxed);
+        requestedSustain.store(sustain, std::memory_order_relaxed);
+        requestedRelease.store(release, std::memory_order_relaxed);
+        pending.store(true, std::memory_order_release);
+    }
+
+    // Audio block only, before any voice renders
+    void update() {
+        if (!pending.exchange(false, std::memory_order_acquire)) {
+            return;
+        }
+        const float attack = requestedAttack.load(std::memory_order_relaxed);
+        if (attack != attackTime) {
+            attackTime = attack;
+            attackSegment.setTime(attack, sampleRate, (attackTarget - 1.f) / attackTarget);
+        }
+        const float decay = requestedDecay.load(std::memory_order_relaxed);
+        if (decay != decayTime) {
+            decayTime = decay;
+            decaySegment.setTime(decay, sampleRate, settleRatio);
+        }
+        const float release = requestedRelease.load(std::memory_order_relaxed);
+        if (release != releaseTime) {
+            releaseTime = release;
+            releaseSegment.setTime(release, sampleRate, settleRatio);
+        }
+        sustain = requestedSustain.load(std::memory_order_relaxed);
+    }
+
+    // 0 : every note at full level, 1 : level follows velocity
+    void setVelocitySensitivity(float amount) {
+        velocitySensitivity = amount;
+    }
+
+    inline float velocityGain(int velocity) const noexcept {
+        return 1.f - velocitySensitivity + velocitySensitivity * (velocity / 127.f);
+    }
+
+public:
+    static constexpr float attackTarget = 1.3f; // Overshoot, like a charging capacitor
+    static constexpr float settleRatio = 0.001f; // Decay and release times are to -60 dB
+    static constexpr float silence = 0.0001f;
+
+    EnvelopeSegment attackSegment;
+    EnvelopeSegment decaySegment;
+    EnvelopeSegment releaseSegment;
+    float sustain = 1.f;
+
+private:
+    float sampleRate = 48000.f;
+    float attackTime = 0.01f;
+    float decayTime = 0.1f;
+    float releaseTime = 0.1f;
+    float velocitySensitivity = 0.f;
+
+    std::atomic<float> requestedAttack {0.01f};
+    std::atomic<float> requestedDecay {0.1f};
+    std::atomic<float> requestedSustain {1.f};
+    std::atomic<float> requestedRelease {0.1f};
+    std::atomic<bool> pending {false};
+};
+
+// Analog style ADSR rendered a block at a time. Each stage is a closed form
+// exponential, the stage ends are solved for instead of tested per sample.
+class Envelope {
+public:
+    enum Stage {
+        Idle = 0,
+        Attack,
+        Decay,
+        Sustain,
+        Release
+    };
+
+public:
+    void init(const EnvelopeShape* shape) {
+        this->shape = shape;
+        stage = Idle;
+        level = 0.f;
+    }
+
+    // Restarts the attack from the current level
+    void gateOn(int velocity) {
+        gain = shape->velocityGain(velocity);
+        stage = Attack;
+    }
+
+    void gateOff() {
+        if (stage != Idle) {
+            stage = Release;
+        }
+    }
+
+    inline bool isActive() const noexcept {
+        return stage != Idle;
+    }
+
+    inline Stage getStage() const noexcept {
+        return stage;
+    }
+
+    // Level reached at the end of the last block, velocity included
+    inline float getLevel() const noexcept {
+        return level * gain;
+    }
+
+    void process(float* out, size_t frameCount) {
+        size_t frame = 0;
+        while (frame < frameCount) {
+            const size_t remaining = frameCount - frame;
+            switch (stage) {
+                case Attack: {
+                    const float target = EnvelopeShape::attackTarget;
+                    const int length = shape->attackSegment.framesUntil(target - level, target - 1.f);
+                    frame += renderSegment(out + frame, remaining, length, shape->attackSegment, target);
+                    if (level >= 1.f || length <= (int)remaining) {
+                        level = 1.f;
+                        stage = Decay;
+                    }
+                }
+                    break;
+                case Decay:
+                case Sustain: {
+                    const float target = shape->sustain;
+                    const int length = shape->decaySegment.framesUntil(fabsf(level - target), EnvelopeShape::silence);
+                    if (length == 0) {
+                        stage = Sustain;
+                        level = target;
+                        fill(out + frame, remaining, level);
+                        frame = frameCount;
+                    } else {
+                        stage = Decay; // Sustain level moved
+                        frame += renderSegment(out + frame, remaining, length, shape->decaySegment, target);
+                    }
+                }
+                    break;
+                case Release: {
+                    const int length = shape->releaseSegment.framesUntil(level, EnvelopeShape::silence);
+                    frame += renderSegment(out + frame, remaining, length, shape->releaseSegment, 0.f);
+                    if (length <= (int)remaining) {
+                        level = 0.f;
+                        stage = Idle;
+                    }
+                }
+                    break;
+                case Idle:
+                default:
+                    fill(out + frame, remaining, 0.f);
+                    frame = frameCount;
+                    break;
+            }
+        }
+    }
+
+private:
+    // Renders up to length frames of the segment, returns how many were written
+    inline size_t renderSegment(float* out, size_t remaining, int length, const EnvelopeSegment& segment, float target) noexcept {
+        const size_t count = length < (int)remaining ? (size_t)length : remaining;
+        const float distance = level - target;
+        const float* powers = segment.powers + 1;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = (target + distance * powers[i]) * gain;
+        }
+        level = target + distance * segment.powers[count];
+        return count;
+    }
+
+    inline void fill(float* out, size_t count, float value) noexcept {
+        const float scaled = value * gain;
+        for (size_t i = 0; i < count; i++) {
+            out[i] = scaled;
+        }
+    }
+
+private:
+    const EnvelopeShape* shape = nullptr;
+    Stage stage = Idle;
+    float level = 0.f;
+    float gain = 1.f;
+};
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    EventTrace.h
+    Created: 19 Oct 2026 4:06:22am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#ifndef EVENT_TRACE
+#define EVENT_TRACE 1
+#endif
+
+#define TRACE_EVENT_COUNT 512 // Power of 2
+
+enum TraceEventType : uint8_t {
+    Trace_BlockStart = 0,   // b : frame count
+    Trace_BlockEnd,         // b : block duration in us
+    Trace_Overrun,          // b : block duration in us
+    Trace_NoteOn,           // a : pitch, b : velocity
+    Trace_NoteOff,          // a : pitch
+    Trace_VoiceAlloc,       // a : voice, b : pitch
+    Trace_VoiceSteal,       // a : voice, b : pitch
+    Trace_PlayMode,         // a : mode
+    Trace_PresetLoad,       // b : changed parameter count
+
+    Trace_Count
+};
+
+struct TraceEvent {
+    uint32_t time;
+    uint8_t type;
+    uint8_t a;
+    uint16_t b;
+};
+
+// Ring buffer the audio block and the main loop both write to, the oldest
+// events get overwritten. A writer claims its slot with one atomic add, the
+// slot sequence tells a snapshot taken at any time which slots are complete.
+class EventTrace {
+public:
+    typedef uint32_t (*Clock)();
+
+public:
+    void setClock(Clock clock) {
+        this->clock = clock;
+    }
+
+    inline uint32_t now() noexcept {
+        return clock ? clock() : 0;
+    }
+
+    inline void write(TraceEventType type, uint8_t a = 0, uint16_t b = 0) noexcept {
+#if EVENT_TRACE
+        const uint32_t index = head.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t slot = index & mask;
+        sequence[slot].store(0, std::memory_order_relaxed); // Being written
+        std::atomic_thread_fence(std::memory_order_release);
+        events[slot] = { now(), type, a, b };
+        sequence[slot].store(index + 1, std::memory_order_release);
+#endif
+    }
+
+    // Copies the latest events, oldest first, returns how many were copied
+    size_t snapshot(TraceEvent* out, size_t maxCount) {
+        const uint32_t end = head.load(std::memory_order_acquire);
+        size_t count = end < TRACE_EVENT_COUNT ? end : TRACE_EVENT_COUNT;
+        if (count > maxCount) {
+            count = maxCount;
+        }
+        const uint32_t start = end - (uint32_t)count;
+        size_t copied = 0;
+        for (size_t k = 0; k < count; k++) {
+            // Skip the slots still being written or overwritten while we copy
+            const uint32_t index = start + (uint32_t)k;
+            const uint32_t slot = index & mask;
+            if (sequence[slot].load(std::memory_order_acquire) != index + 1) {
+                continue;
+            }
+            const TraceEvent event = events[slot];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence[slot].load(std::memory_order_relaxed) == index + 1) {
+                out[copied++] = event;
+            }
+        }
+        return copied;
+    }
+
+    inline uint32_t getOverrunCount() noexcept {
+        return overrunCount.load(std::memory_order_relaxed);
+    }
+
+    inline void addOverrun(uint16_t duration) noexcept {
+        overrunCount.fetch_add(1, std::memory_order_relaxed);
+        write(Trace_Overrun, 0, duration);
+    }
+
+private:
+    static constexpr uint32_t mask = TRACE_EVENT_COUNT - 1;
+
+    TraceEvent events[TRACE_EVENT_COUNT];
+    std::atomic<uint32_t> sequence[TRACE_EVENT_COUNT] {}; // Event index + 1 once written
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> overrunCount {0};
+    Clock clock = nullptr;
+};
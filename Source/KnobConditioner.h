@@ -0,0 +1,117 @@
+/*
+  ==============================================================================
+
+    KnobConditioner.h
+    Created: 19 Oct 2026 3:55:14am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+
+// Sits between the ADC reading and the parameter : an idle or jittering
+// knob produces nothing, a moving one at most one value per interval.
+class KnobConditioner {
+public:
+    void init(float deadband, float hysteresis, uint32_t minIntervalMs) {
+        this->deadband = deadband;
+        this->hysteresis = hysteresis;
+        this->minIntervalMs = minIntervalMs;
+    }
+    
+    // True when the value should be sent right now
+    bool process(float value, uint32_t nowMs) {
+        if (pickingUp) {
+            const bool reached = fabsf(value - pickupTarget) < deadband || (value < pickupTarget) != pickupFromBelow;
+            if (!reached) {
+                return false;
+            }
+            pickingUp = false;
+        }
+        
+        float delta = value - lastValue;
+        int8_t direction = delta > 0.f ? 1 : -1;
+        
+        // Adaptive deadband : tighter while the knob is being turned
+        float threshold = (nowMs - lastMoveMs < settleMs) ? deadband * 0.5f : deadband;
+        if (direction != lastDirection) {
+            threshold += hysteresis;
+        }
+        if (fabsf(delta) < threshold) {
+            return false;
+        }
+        
+        lastValue = value;
+        lastDirection = direction;
+        lastMoveMs = nowMs;
+        
+        if (nowMs - lastSentMs < minIntervalMs) {
+            pending = true;
+            return false;
+        }
+        pending = false;
+        lastSentMs = nowMs;
+        return true;
+    }
+    
+    // True when a rate-limited value is due
+    bool flush(uint32_t nowMs) {
+        if (!pending || nowMs - lastSentMs < minIntervalMs) {
+            return false;
+        }
+        pending = false;
+        lastSentMs = nowMs;
+        return true;
+    }
+    
+    inline float getValue() noexcept {
+        return lastValue;
+    }
+    
+    // Boot : follows the reading without sending anything, so the first
+    // real move is measured from where the knob settled
+    void track(float value, uint32_t nowMs) {
+        if (fabsf(value - lastValue) >= deadband) {
+            lastValue = value;
+            lastMoveMs = nowMs;
+        }
+        pending = false;
+        tracked = true;
+    }
+    
+    // Nothing is sent until the knob reaches target, for a knob taking over
+    // a value it wasn't driving
+    void pickup(float target) {
+        pickupTarget = target;
+        pickupFromBelow = lastValue < target;
+        pickingUp = true;
+        pending = false;
+    }
+    
+    // No reading yet counts as stable : a locked knob may never report
+    inline bool isStable(uint32_t nowMs, uint32_t stableMs) const noexcept {
+        return !tracked || nowMs - lastMoveMs >= stableMs;
+    }
+    
+private:
+    static constexpr uint32_t settleMs = 250;
+    
+    float deadband = 0.004f;
+    float hysteresis = 0.002f;
+    uint32_t minIntervalMs = 10;
+    
+    float lastValue = -1.f;
+    int8_t lastDirection = 0;
+    uint32_t lastMoveMs = 0;
+    uint32_t lastSentMs = 0;
+    bool pending = false;
+    bool tracked = false;
+    
+    float pickupTarget = 0.f;
+    bool pickupFromBelow = false;
+    bool pickingUp = false;
+};
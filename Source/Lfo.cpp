@@ -11,8 +11,10 @@
 #include "Lfo.h"
 #include "DaisyYMNK/DSP/DSP.h"
 
+constexpr const char* Lfo::destinationNames[];
+
 Lfo::Lfo() {
-    uint8_t k = lfoBufSize;
+    size_t k = MAX_BLOCK_SIZE;
     while (k--) {
         buffer[k] = 0;
     }
@@ -56,7 +58,7 @@ void Lfo::process(size_t frameCount) {
     }
 }
 
-float Lfo::getBuffer(LfoDest target, uint8_t frame, float multiplier) {
+float Lfo::getBuffer(LfoDest target, size_t frame, float multiplier) {
     if (target != dest) {
         return 0;
     }
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "daisysp.h"
+#include "BlockSize.h"
 
 using namespace std;
 using namespace daisysp;
@@ -25,7 +26,7 @@ public:
         LfoDest_Count
     };
     
-    const char* destinationNames[3] = {
+    static constexpr const char* destinationNames[LfoDest_Count] = {
         "None", "Pitch", "FilterCutoff"
     };
     
@@ -51,13 +52,12 @@ public:
     
     void setDestinationValue(float value);
     
-    float getBuffer(LfoDest target, uint8_t frame, float multiplier = 1.f);
+    float getBuffer(LfoDest target, size_t frame, float multiplier = 1.f);
     
     const LfoDest& getDestination();
 
 private:
-    static constexpr uint8_t lfoBufSize = 128;
-    float buffer[lfoBufSize];
+    float buffer[MAX_BLOCK_SIZE];
     
     Oscillator osc;
     LfoDest dest;
@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    MasterBus.h
+    Created: 19 Oct 2026 4:19:54am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+#include "Chorus.h"
+#include "StereoDelay.h"
+
+#define MASTER_BUS_GAIN 0.333f // Headroom before the clipper, the voices sum well above 1
+
+// Effect delay lines, in floats : 50 ms of chorus and 1.3 s of delay per side at 48 kHz
+#define EFFECTS_MEMORY_SIZE (2 * 4096 + 2 * 65536)
+
+// Stereo output stage, a block at a time : ramped gain, one pole high pass,
+// chorus, delay, soft clip. The channel fan-out is left to the caller.
+class MasterBus {
+public:
+    void init(float sampleRate) {
+        this->sampleRate = sampleRate;
+        for (auto& state : channels) {
+            state = ChannelState();
+        }
+        setHighPass(10.f);
+    }
+
+    // Floats the effects need for their full length at this sample rate
+    static size_t effectsMemoryFor(float sampleRate) {
+        return 2 * DelayLine::floorPowerOf2((size_t)(2 * CHORUS_MAX_SECONDS * sampleRate))
+             + 2 * DelayLine::floorPowerOf2((size_t)(2 * DELAY_MAX_SECONDS * sampleRate));
+    }
+
+    // Splits the memory between the chorus and the delay, call after init
+    void initEffects(float* memory, size_t size) {
+        const size_t chorusLength = std::min(DelayLine::floorPowerOf2((size_t)(2 * CHORUS_MAX_SECONDS * sampleRate)), DelayLine::floorPowerOf2(size / 4));
+        const size_t delayWanted = DelayLine::floorPowerOf2((size_t)(2 * DELAY_MAX_SECONDS * sampleRate));
+        const size_t delayLength = std::min(delayWanted, DelayLine::floorPowerOf2((size - 2 * chorusLength) / 2));
+        chorus.init(sampleRate, memory, chorusLength);
+        delay.init(sampleRate, memory + 2 * chorusLength, delayLength);
+    }
+
+    Chorus& getChorus() {
+        return chorus;
+    }
+
+    StereoDelay& getDelay() {
+        return delay;
+    }
+
+    void setOutputGain(float gain) {
+        outputGain = gain;
+    }
+
+    void setHighPass(float freq) {
+        hpCoef = expf(-2.f * (float)M_PI * freq / sampleRate);
+    }
+
+    // The volume comes smoothed (a glide parameter), both it and the declick
+    // ramp over the block from their previous values
+    void process(float* left, float* right, size_t frameCount, float volume, float declickFrom, float declickTo) {
+        const float volumeFrom = this->volume;
+        this->volume = volume;
+
+        const float gainFrom = volumeFrom * declickFrom * outputGain;
+        const float gainTo = volume * declickTo * outputGain;
+        const float gainStep = (gainTo - gainFrom) / frameCount;
+
+        processChannel(left, channels[0], frameCount, gainFrom, gainStep);
+        processChannel(right, channels[1], frameCount, gainFrom, gainStep);
+
+        chorus.process(left, right, frameCount);
+        delay.process(left, right, frameCount);
+
+        for (size_t i = 0; i < frameCount; i++) {
+            left[i] = softClip(left[i]);
+        }
+        for (size_t i = 0; i < frameCount; i++) {
+            right[i] = softClip(right[i]);
+        }
+    }
+
+private:
+    struct ChannelState {
+        float x1 = 0.f;
+        float y1 = 0.f;
+    };
+
+    inline void processChannel(float* buf, ChannelState& state, size_t frameCount, float gainFrom, float gainStep) noexcept {
+        for (size_t i = 0; i < frameCount; i++) {
+            buf[i] *= gainFrom + gainStep * (i + 1);
+        }
+
+        // The only recursive loop
+        float x1 = state.x1;
+        float y1 = state.y1;
+        for (size_t i = 0; i < frameCount; i++) {
+            const float x = buf[i];
+            y1 = hpCoef * (y1 + x - x1);
+            x1 = x;
+            buf[i] = y1;
+        }
+        state.x1 = x1;
+        state.y1 = y1;
+    }
+
+    // Cubic, flat from +-1.5 : no branch, no division
+    static inline float softClip(float x) noexcept {
+        x = fminf(fmaxf(x, -1.5f), 1.5f);
+        return x - x * x * x * (1.f / 6.75f);
+    }
+
+private:
+    float sampleRate = 48000.f;
+    float outputGain = MASTER_BUS_GAIN;
+    float volume = 0.f;
+    float hpCoef = 1.f;
+    ChannelState channels[2];
+    
+    Chorus chorus;
+    StereoDelay delay;
+};
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    NoteQueue.h
+    Created: 19 Oct 2026 4:58:37am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#define NOTE_QUEUE_SIZE 64 // Power of 2
+
+struct NoteEvent {
+    enum Type : uint8_t {
+        NoteOn = 0,
+        NoteOff,
+        AllNotesOff
+    };
+
+    Type type;
+    uint8_t pitch;
+    uint8_t velocity;
+};
+
+// Key events from wherever MIDI is read (the main loop on the Daisy) to the
+// audio block, which alone touches the arpeggiator and the voices. One
+// producer, one consumer, no locks.
+class NoteQueue {
+public:
+    // Producer, false when full : the audio block drains it every block
+    bool push(const NoteEvent& event) {
+        const uint32_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - head.load(std::memory_order_acquire) == NOTE_QUEUE_SIZE) {
+            return false;
+        }
+        events[tail & mask] = event;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer
+    bool pop(NoteEvent& event) {
+        const uint32_t head = this->head.load(std::memory_order_relaxed);
+        if (head == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        event = events[head & mask];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t mask = NOTE_QUEUE_SIZE - 1;
+
+    NoteEvent events[NOTE_QUEUE_SIZE];
+    std::atomic<uint32_t> head {0};
+    std::atomic<uint32_t> tail {0};
+};
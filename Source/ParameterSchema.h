@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    ParameterSchema.h
+    Created: 19 Oct 2026 4:18:44am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "DaisyYMNK/QSPI/PresetManager.h"
+#include "PolySynth.h"
+#include "Lfo.h"
+#include "ControlMap.h"
+#include "Chorus.h"
+#include "StereoDelay.h"
+#include "Arpeggiator.h"
+
+// Every parameter is described once, here. The enum, the names given to the
+// kernel, the value curves, the CC map, the panel knobs and the preset layout
+// are all generated from this list.
+//
+// X(id, name, kind, curve, smooth, min, max, default, cc, knob)
+//   kind   : Continuous (applied as it comes), BlockRate (drives settings that
+//            are recomputed on change, pushed once at init), Discrete (a switch :
+//            declicked on preset change, jumps halfway through a morph)
+//   curve  : how the 0..1 value maps to min..max (Linear, Square, Cube, Exp)
+//   smooth : None (applied as set), Glide (eased in over PARAMETER_GLIDE_TIME,
+//            one step per audio sub block)
+//   default: engine value at first launch, and for the parameters a preset
+//            saved before they were appended doesn't hold
+//   cc     : default MIDI CC
+//   knob   : panel knob in PolyAnalogCore order (mux 0..15, then Volume,
+//            Cutoff, Res), -1 for none
+//
+// Presets store the values in this order : only ever append.
+
+#define LFO_SCHEMA(X, _name, _dest, _cc, _rateKnob, _amountKnob) \
+X(LfoType##_name,        "LfoType" #_name,        Discrete,   Linear, None, 0, Lfo::LfoType_Count - 1, 0,     _cc,     -1) \
+X(LfoDestination##_name, "LfoDestination" #_name, Discrete,   Linear, None, 0, Lfo::LfoDest_Count - 1, _dest, _cc + 1, -1) \
+X(LfoRate##_name,        "LfoRate" #_name,        BlockRate,  Linear, None, 0, 1,                      0,     _cc + 2, _rateKnob) \
+X(LfoAmount##_name,      "LfoAmount" #_name,      BlockRate,  Linear, None, 0, 1,                      0,     _cc + 3, _amountKnob)
+
+#define POLYANALOG_PARAMETERS(X) \
+X(PlayMode,         "Play Mode",        Discrete,   Linear, None,  0,      2,                                  0,                          10, -1) \
+X(Glide,            "Glide",            BlockRate,  Linear, None,  0,      1,                                  0,                          11, 6) \
+X(Volume,           "Volume",           Continuous, Linear, Glide, 0,      1,                                  0,                          12, 16) \
+X(OscWaveformA,     "OscWaveformA",     Continuous, Linear, None,  0,      1,                                  0,                          13, 2) \
+X(OscOctaveA,       "OscOctaveA",       Discrete,   Linear, None,  -2,     2,                                  -2,                         14, 3) \
+X(OscWaveformB,     "OscWaveformB",     Continuous, Linear, None,  0,      1,                                  0,                          15, 1) \
+X(OscTuneB,         "OscTuneB",         Discrete,   Linear, None,  0,      SynthVoice::btuneCount - 1,         0,                          16, 4) \
+X(OscNoise,         "OscNoise",         Continuous, Linear, Glide, 0,      1,                                  0,                          17, 5) \
+X(OscMix,           "OscMix",           Continuous, Linear, Glide, 0,      1,                                  0,                          18, 0) \
+X(FilterCutoff,     "FilterCutoff",     Continuous, Linear, Glide, 15,     135,                                15,                         19, 17) \
+X(FilterRes,        "FilterRes",        Continuous, Exp,    Glide, 1,      32,                                 1,                          20, 18) \
+X(FilterEnv,        "FilterEnv",        Continuous, Linear, Glide, 0,      1,                                  0,                          21, 8) \
+X(Attack,           "Attack",           BlockRate,  Cube,   None,  0.002f, 16,                                 0.002f,                     22, 11) \
+X(Decay,            "Decay",            BlockRate,  Cube,   None,  0.005f, 8,                                  0.005f,                     23, 9) \
+X(Sustain,          "Sustain",          BlockRate,  Linear, None,  0,      1,                                  0,                          24, 10) \
+X(HighPass,         "HighPass",         Continuous, Linear, Glide, 15,     135,                                15,                         25, 7) \
+LFO_SCHEMA(X, A, Lfo::LfoDest_Pitch, 26, 15, 14) \
+LFO_SCHEMA(X, B, Lfo::LfoDest_FilterCutoff, 30, 13, 12) \
+X(Spread,           "Spread",           Continuous, Linear, None,  0,      1,                                  0,                          34, -1) \
+X(FilterType,       "FilterType",       Discrete,   Linear, None,  0,      SynthVoice::FilterType_Count - 1,   0,                          35, -1) \
+X(UnisonVoices,     "UnisonVoices",     Discrete,   Linear, None,  2,      VOICE_COUNT,                        UNISON_VOICE_COUNT,         36, -1) \
+X(UnisonDetune,     "UnisonDetune",     Continuous, Square, None,  0,      0.5f,                               UNISON_DETUNE,              37, -1) \
+X(UnisonCurve,      "UnisonCurve",      Discrete,   Linear, None,  0,      PolySynth::UnisonCurve_Count - 1,   0,                          39, -1) \
+X(UnisonPhase,      "UnisonPhase",      Continuous, Linear, None,  0,      1,                                  0,                          40, -1) \
+X(Velocity,         "Velocity",         Continuous, Linear, None,  0,      1,                                  0,                          41, -1) \
+X(ChorusMix,        "ChorusMix",        Continuous, Linear, None,  0,      1,                                  0,                          42, -1) \
+X(ChorusRate,       "ChorusRate",       Continuous, Square, None,  0.05f,  5,                                  CHORUS_DEFAULT_RATE,        43, -1) \
+X(ChorusDepth,      "ChorusDepth",      Continuous, Linear, None,  0,      1,                                  CHORUS_DEFAULT_DEPTH,       44, -1) \
+X(DelayMix,         "DelayMix",         Continuous, Linear, None,  0,      1,                                  0,                          45, -1) \
+X(DelayTime,        "DelayTime",        Continuous, Square, None,  0.02f,  DELAY_MAX_SECONDS,                  DELAY_DEFAULT_TIME,         46, -1) \
+X(DelaySync,        "DelaySync",        Discrete,   Linear, None,  0,      StereoDelay::Sync_Count - 1,        0,                          47, -1) \
+X(DelayFeedback,    "DelayFeedback",    Continuous, Linear, None,  0,      0.95f,                              DELAY_DEFAULT_FEEDBACK,     48, -1) \
+X(Tempo,            "Tempo",            BlockRate,  Linear, None,  40,     240,                                ARP_DEFAULT_TEMPO,          49, -1) \
+X(ArpMode,          "ArpMode",          Discrete,   Linear, None,  0,      Arpeggiator::Mode_Count - 1,        0,                          50, -1) \
+X(ArpOctaves,       "ArpOctaves",       Discrete,   Linear, None,  1,      ARP_MAX_OCTAVES,                    1,                          51, -1) \
+X(ArpDivision,      "ArpDivision",      Discrete,   Linear, None,  0,      Arpeggiator::Division_Count - 1,    Arpeggiator::Division_8th,  52, -1) \
+X(ArpGate,          "ArpGate",          Continuous, Linear, None,  0.05f,  1,                                  ARP_DEFAULT_GATE,           53, -1) \
+X(ArpClock,         "ArpClock",         Discrete,   Linear, None,  0,      Arpeggiator::clockSourceCount - 1,  0,                          54, -1) \
+X(SeqRecord,        "SeqRecord",        Discrete,   Linear, None,  0,      1,                                  0,                          55, -1)
+
+#define PANEL_KNOB_COUNT 19 // 16 mux knobs, Volume, Cutoff, Res
+#define PARAMETER_GLIDE_TIME 0.01f // Seconds
+#define LEGACY_PRESET_SIZE 24 // Parameters in the presets PresetManager saved, up to LfoAmountB
+
+enum ParameterKind : uint8_t {
+    Param_Continuous = 0,
+    Param_BlockRate,
+    Param_Discrete
+};
+
+enum ParameterCurve : uint8_t {
+    Curve_Linear = 0,
+    Curve_Square,
+    Curve_Cube,
+    Curve_Exp
+};
+
+enum ParameterSmoothing : uint8_t {
+    Smooth_None = 0,
+    Smooth_Glide
+};
+
+struct ParameterInfo {
+    const char* name;
+    ParameterKind kind;
+    ParameterCurve curve;
+    ParameterSmoothing smooth;
+    float min;
+    float max;
+    float defaultValue;
+    uint8_t cc;
+    int8_t knob;
+};
+
+#define PARAMETER_INFO(_id, _name, _kind, _curve, _smooth, _min, _max, _default, _cc, _knob) \
+{_name, Param_##_kind, Curve_##_curve, Smooth_##_smooth, (float)(_min), (float)(_max), (float)(_default), _cc, _knob},
+
+constexpr ParameterInfo parameterSchema[] = {
+    POLYANALOG_PARAMETERS(PARAMETER_INFO)
+};
+
+constexpr int parameterCount = sizeof(parameterSchema) / sizeof(ParameterInfo);
+
+// 0..1 to the parameter range, discrete parameters land on whole numbers
+inline float mapParameter(int index, float value) {
+    const ParameterInfo& info = parameterSchema[index];
+    value = fclamp(value, 0.f, 1.f);
+    if (info.kind == Param_Discrete) {
+        return (float)valueMap(value, (int)info.min, (int)info.max);
+    }
+    switch (info.curve) {
+        case Curve_Square:
+            return info.min + value * value * (info.max - info.min);
+        case Curve_Cube:
+            return valueMapPow3(value, info.min, info.max);
+        case Curve_Exp:
+            return info.min * expf(value * logf(info.max / info.min));
+        case Curve_Linear:
+        default:
+            return info.min + value * (info.max - info.min);
+    }
+}
+
+// Parameter range back to 0..1, to seed a parameter with its engine default
+inline float normalizeParameter(int index, float mapped) {
+    const ParameterInfo& info = parameterSchema[index];
+    mapped = fclamp(mapped, info.min, info.max);
+    if (info.max == info.min) {
+        return 0.f;
+    }
+    if (info.kind == Param_Discrete) {
+        return (mapped - info.min) / (info.max - info.min);
+    }
+    switch (info.curve) {
+        case Curve_Square:
+            return sqrtf((mapped - info.min) / (info.max - info.min));
+        case Curve_Cube:
+            return cbrtf((mapped - info.min) / (info.max - info.min));
+        case Curve_Exp:
+            return logf(mapped / info.min) / logf(info.max / info.min);
+        case Curve_Linear:
+        default:
+            return (mapped - info.min) / (info.max - info.min);
+    }
+}
+
+// The default column as a 0..1 value
+inline float parameterDefault(int index) {
+    return normalizeParameter(index, parameterSchema[index].defaultValue);
+}
+
+// Completes a preset holding only its first size values, saved before the
+// parameters after them were appended
+inline void fillParameterDefaults(float* values, int size) {
+    for (int i = size < 0 ? 0 : size; i < parameterCount; i++) {
+        values[i] = parameterDefault(i);
+    }
+}
+
+//==============================================================================
+// Compile time checks and tables
+
+constexpr bool schemaControllersAreValid() {
+    for (int i = 0; i < parameterCount; i++) {
+        if (ControlMap::isReserved(parameterSchema[i].cc)) {
+            return false;
+        }
+        for (int j = 0; j < i; j++) {
+            if (parameterSchema[i].cc == parameterSchema[j].cc) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool schemaKnobsAreValid() {
+    for (int knob = 0; knob < PANEL_KNOB_COUNT; knob++) {
+        int count = 0;
+        for (int i = 0; i < parameterCount; i++) {
+            count += parameterSchema[i].knob == knob;
+        }
+        if (count != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(parameterCount <= MAX_PRESET_SIZE, "Presets can't hold every parameter");
+static_assert(schemaControllersAreValid(), "A CC is reserved or used twice");
+static_assert(schemaKnobsAreValid(), "Every panel knob needs exactly one parameter");
+
+struct KnobTable {
+    int parameters[PANEL_KNOB_COUNT];
+};
+
+constexpr KnobTable makeKnobTable() {
+    KnobTable table = {};
+    for (int i = 0; i < parameterCount; i++) {
+        if (parameterSchema[i].knob >= 0) {
+            table.parameters[parameterSchema[i].knob] = i;
+        }
+    }
+    return table;
+}
+
+constexpr KnobTable knobParameters = makeKnobTable();
+
+// The parameters the audio block eases in
+struct GlideTable {
+    int parameters[parameterCount];
+    int count;
+};
+
+constexpr GlideTable makeGlideTable() {
+    GlideTable table = {};
+    for (int i = 0; i < parameterCount; i++) {
+        if (parameterSchema[i].smooth == Smooth_Glide) {
+            table.parameters[table.count++] = i;
+        }
+    }
+    return table;
+}
+
+constexpr GlideTable glideParameters = makeGlideTable();
@@ -9,7 +9,6 @@
 */
 
 #include "PolyAnalogCore.h"
-#include "DaisyYMNK/Helpers/StrConverters.h"
 
 bool isBetweenParameterIndex(int x, int a, int b) {
     return x >= a && x <= b;
@@ -47,9 +46,15 @@ PolyAnalogCore::PolyAnalogCore()
         {MidiLed,                   kLed,       10,             "Led"},
      }, (5 - 1)) //do something for midi channel who's not correct
 {
-    lockAllKnobs();
+    for (int knob = MuxKnob_1; knob <= MuxKnob_16; knob++) {
+        knobConditioners[knob].init(0.006f, 0.003f, 20);
+    }
+    // Front panel knobs are the ones played live
+    knobConditioners[KnobVolume].init(0.004f, 0.002f, 10);
+    knobConditioners[KnobCutoff].init(0.002f, 0.001f, 5);
+    knobConditioners[KnobRes].init(0.004f, 0.002f, 10);
     
-    needsResetDisplay = true;
+    lockAllKnobs();
 }
 
 void PolyAnalogCore::lockAllKnobs() {
@@ -59,10 +64,69 @@ void PolyAnalogCore::lockAllKnobs() {
 }
 
 void PolyAnalogCore::loadPreset(const float* values) {
-    dspKernel->loadPreset(values);
+    polySynth.stagePreset(values);
     lockAllKnobs();
 }
 
+void PolyAnalogCore::initPresets(daisy::QSPIHandle* qspi) {
+    presetCache.init(presetManager, qspi);
+}
+
+// Last stage of the audio boot : an empty slot leaves the defaults playing
+void PolyAnalogCore::loadBootPreset() {
+    applyCurrentPreset();
+}
+
+bool PolyAnalogCore::hasStagedPreset() {
+    return polySynth.hasStagedPreset();
+}
+
+void PolyAnalogCore::beginHIDSettle(uint32_t nowMs) {
+    hidSettling = true;
+    hidSettleStartMs = nowMs;
+}
+
+// True on the call that ends the settling
+bool PolyAnalogCore::updateHIDSettle(uint32_t nowMs) {
+    if (!hidSettling) {
+        return false;
+    }
+    const uint32_t elapsed = nowMs - hidSettleStartMs;
+    if (elapsed < HID_SETTLE_MIN_MS) {
+        return false;
+    }
+    bool stable = true;
+    for (int knob = 0; knob < knobCount && stable; knob++) {
+        stable = knobConditioners[knob].isStable(nowMs, HID_SETTLE_STABLE_MS);
+    }
+    if (!stable && elapsed < HID_SETTLE_TIMEOUT_MS) {
+        return false;
+    }
+    hidSettling = false;
+    lockAllKnobs(); // The boot preset stays until a knob is moved
+    return true;
+}
+
+void PolyAnalogCore::processPresetWrites() {
+    auto status = presetCache.processWrites();
+    if (status == PresetCache::WriteStatus_Idle || status == PresetCache::WriteStatus_Writing) {
+        return;
+    }
+    if (status == PresetCache::WriteStatus_Success) {
+        display.postMessage("Save Success!", "", messageHoldMs);
+    } else {
+        display.postMessage("Save Failed!", "", messageHoldMs);
+    }
+}
+
+EventTrace& PolyAnalogCore::getTrace() {
+    return polySynth.getTrace();
+}
+
+void PolyAnalogCore::setEffectsMemory(float* memory, size_t size) {
+    polySynth.setEffectsMemory(memory, size);
+}
+
 void PolyAnalogCore::changeCurrentPreset(bool increment) {
     if (increment) {
         currentPreset.increment();
@@ -70,13 +134,27 @@ void PolyAnalogCore::changeCurrentPreset(bool increment) {
         currentPreset.decrement();
     }
     
-    const float* dataToLoad = presetManager->Load(currentPreset.get());
+    applyCurrentPreset();
+    
+    char number[12];
+    DisplayModel::formatInt(currentPreset.get(), number);
+    display.postMessage("Load Preset", number, messageHoldMs);
+}
+
+void PolyAnalogCore::applyCurrentPreset() {
+    const float* dataToLoad = presetCache.load(currentPreset.get());
     if (dataToLoad) {
         loadPreset(dataToLoad);
+        polySynth.setMorphPreset(PolyAnalogDSP::MorphA, dataToLoad);
+        
+        // Next slot is the morph target
+        BoundedInt<0,15> morphPreset = currentPreset;
+        morphPreset.increment();
+        const float* morphData = presetCache.load(morphPreset.get());
+        if (morphData) {
+            polySynth.setMorphPreset(PolyAnalogDSP::MorphB, morphData);
+        }
     }
-    intToCString2(currentPreset.get(), numCharBuffer);
-    displayManager->Write("Load Preset", numCharBuffer);
-    needsResetDisplay = true;
 }
 
 void PolyAnalogCore::saveCurrentPreset() {
@@ -87,45 +165,46 @@ void PolyAnalogCore::saveCurrentPreset() {
         pData[k++] = param->getUIValue();
     }
 
-    bool result = presetManager->Save(pData, k, currentPreset.get());
-    if (result) {
-        displayManager->Write("Save Success!");
-    } else {
-        displayManager->Write("Save Failed!");
+    // Written back to QSPI later from the main loop
+    presetCache.save(currentPreset.get(), pData, k);
+    display.postMessage("Saving...", "", messageHoldMs);
+}
+
+bool PolyAnalogCore::updateDisplay(uint32_t nowMs) {
+    if (!display.isDue(nowMs)) {
+        return false;
     }
-    needsResetDisplay = true;
+    int index;
+    if (display.takeParameter(nowMs, index)) {
+        composeParameter(index);
+    }
+    return display.flush(nowMs, *displayManager);
 }
 
-void PolyAnalogCore::displayValuesOnScreen() {
-    if (!needsToUpdateValue) {
+// Name on line 1, value on line 2 : switches as whole numbers, the rest as 0.00 to 1.00
+void PolyAnalogCore::composeParameter(int index) {
+    Parameter* parameter = dspKernel->getParameter(index);
+    if (!parameter) {
         return;
     }
-    if (lastParam) {
-        if (lastParamIndex == PolyAnalogDSP::LfoDestinationA) {
-            const char* destName = polySynth.getLfoDestName(0);
-            displayManager->WriteLine(2, destName);
-            
-        } else {
-            float value = lastParam->getUIValue();
-            floatToCString2(value, numCharBuffer);
-            
-            displayManager->WriteLine(2, numCharBuffer);
-        }
+    display.setLine(1, parameter->getName());
+    
+    char value[DISPLAY_LINE_LENGTH];
+    if (index == PolyAnalogDSP::LfoDestinationA || index == PolyAnalogDSP::LfoDestinationB) {
+        display.setLine(2, polySynth.getLfoDestName(index == PolyAnalogDSP::LfoDestinationA ? 0 : 1));
+        return;
     }
-    needsToUpdateValue = false;
+    const float uiValue = parameter->getUIValue();
+    if (parameterSchema[index].kind == Param_Discrete) {
+        DisplayModel::formatInt((int)mapParameter(index, uiValue), value);
+    } else {
+        DisplayModel::formatHundredths((int)(uiValue * 100.f + 0.5f), value);
+    }
+    display.setLine(2, value);
 }
 
-//Well we should make a loop again
 void PolyAnalogCore::displayParameterOnScreen(unsigned int index) {
-    Parameter* lastChanged = dspKernel->getParameter(index);
-    
-    if (lastChanged && lastChanged != lastParam) {
-        const char* name = lastChanged->getName();
-        lastParam = lastChanged;
-        displayManager->WriteLine(1, name);
-    }
-    
-    needsToUpdateValue = true;
+    display.postParameter(index);
 }
 
 void PolyAnalogCore::processMIDI(MIDIMessageType messageType, int channel, int dataA, int dataB) {
@@ -139,12 +218,52 @@ void PolyAnalogCore::processMIDI(MIDIMessageType messageType, int channel, int d
     }
 }
 
+void PolyAnalogCore::updateControls(uint32_t nowMs) {
+    this->nowMs = nowMs;
+    for (int knob = 0; knob < knobCount; knob++) {
+        if (knobConditioners[knob].flush(nowMs)) {
+            applyKnobValue(knob, knobConditioners[knob].getValue());
+        }
+    }
+}
+
+void PolyAnalogCore::applyKnobValue(unsigned int index, float value) {
+    if (index == KnobRes && shiftState) { // Shift turns Res into the morph knob
+        polySynth.setMorphPosition(value);
+        return;
+    }
+    if (index < PANEL_KNOB_COUNT) {
+        const int parameter = knobParameters.parameters[index]; // See ParameterSchema.h
+        dspKernel->setParameterValue(parameter, value);
+        displayParameterOnScreen(parameter);
+    }
+}
+
 void PolyAnalogCore::updateHIDValue(unsigned int index, float value) {
 
+    if (index < knobCount) {
+        if (hidSettling) {
+            knobConditioners[index].track(value, nowMs);
+            return;
+        }
+        if (knobConditioners[index].process(value, nowMs)) {
+            applyKnobValue(index, value);
+        }
+        return;
+    }
+
     switch (index) {
 
-        case ButtonShift:
-            shiftState = (bool)value;
+        case ButtonShift: {
+            const bool shift = (bool)value;
+            if (shift != shiftState) {
+                // Res switches between resonance and morph, it must not drag one to the other
+                knobConditioners[KnobRes].pickup(shift
+                    ? polySynth.getMorphPosition()
+                    : dspKernel->getParameter(knobParameters.parameters[KnobRes])->getUIValue());
+            }
+            shiftState = shift;
+        }
             break;
             
         case ButtonSave: {
@@ -179,15 +298,7 @@ void PolyAnalogCore::updateHIDValue(unsigned int index, float value) {
             //Hmmm, this should never happen
             break;
             
-        case KnobVolume: dspKernel->setParameterValue(PolyAnalogDSP::Volume, value); break;
-        case KnobCutoff: dspKernel->setParameterValue(PolyAnalogDSP::FilterCutoff, value); break;
-        case KnobRes: dspKernel->setParameterValue(PolyAnalogDSP::FilterRes, value); break;
-            
         default:
-            if (isBetweenParameterIndex(index, MuxKnob_1, MuxKnob_16)) {
-                dspKernel->setParameterValue(parameterMap[index - MuxKnob_1], value);
-            }
-            
             break;
     }
 }
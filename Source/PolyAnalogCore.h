@@ -13,16 +13,13 @@
 #include "DaisyYMNK/DSP/DSP.h"
 #include "DaisyYMNK/Helpers/BoundedInt.h"
 #include "PolyAnalogDSP.h"
+#include "PresetCache.h"
+#include "KnobConditioner.h"
+#include "DisplayModel.h"
 
-#define DSP_PARAM_OP(_name) \
-PolyAnalogDSP::Coarse##_name, \
-PolyAnalogDSP::Fine##_name, \
-PolyAnalogDSP::Mode##_name, \
-PolyAnalogDSP::Amount##_name, \
-PolyAnalogDSP::Attack##_name, \
-PolyAnalogDSP::Decay##_name, \
-PolyAnalogDSP::Sustain##_name, \
-PolyAnalogDSP::Release##_name
+#define HID_SETTLE_MIN_MS 50        // Every mux channel has been read a few times
+#define HID_SETTLE_STABLE_MS 30     // A knob this still is settled
+#define HID_SETTLE_TIMEOUT_MS 1000  // The old blocking wait, as an upper bound
 
 class PolyAnalogCore : public ModuleCore {
 public:
@@ -61,6 +58,20 @@ public:
 
     int getCurrentPage();
     void loadPreset(const float* values);
+    
+    void initPresets(daisy::QSPIHandle* qspi);
+    void loadBootPreset();
+    bool hasStagedPreset();
+    void processPresetWrites();
+    
+    // Knobs are read but not applied until their readings are stable
+    void beginHIDSettle(uint32_t nowMs);
+    bool updateHIDSettle(uint32_t nowMs);
+    
+    void updateControls(uint32_t nowMs);
+    
+    EventTrace& getTrace();
+    void setEffectsMemory(float* memory, size_t size);
 
     virtual void processMIDI(MIDIMessageType messageType, int channel, int dataA, int dataB) override;
     
@@ -69,46 +80,34 @@ protected:
     
 private:
     void lockAllKnobs();
+    void applyKnobValue(unsigned int index, float value);
     void changeCurrentPreset(bool increment);
+    void applyCurrentPreset();
     void saveCurrentPreset();
     
     void displayParameterOnScreen(unsigned int index);
+    void composeParameter(int index);
     
 public:
-    void displayValuesOnScreen();
+    // Main loop, redraws what changed at most every DISPLAY_FRAME_MS
+    bool updateDisplay(uint32_t nowMs);
     
 private:
-    int parameterMap[16] = {
-        PolyAnalogDSP::OscMix,
-        PolyAnalogDSP::OscWaveformB,
-        PolyAnalogDSP::OscWaveformA,
-        PolyAnalogDSP::OscOctaveA,
-        PolyAnalogDSP::OscTuneB,
-        PolyAnalogDSP::OscNoise,
-        PolyAnalogDSP::Glide,
-        PolyAnalogDSP::HighPass,
-        PolyAnalogDSP::FilterEnv,
-        PolyAnalogDSP::Decay,
-        PolyAnalogDSP::Sustain,
-        PolyAnalogDSP::Attack,
-        PolyAnalogDSP::LfoAmountB,
-        PolyAnalogDSP::LfoRateB,
-        PolyAnalogDSP::LfoAmountA,
-        PolyAnalogDSP::LfoRateA
-    };
-
     BoundedInt<0,15> currentPreset = 0;
     
-    char numCharBuffer[4];
-    char fullNumCharBuffer[20];
+    DisplayModel display;
+    static constexpr uint32_t messageHoldMs = 800;
     
-    ydaisy::Parameter* lastParam = nullptr;
-    int lastParamIndex = 0;
-    bool needsToUpdateValue = false;
-    
-    bool needsResetDisplay = false;
+    static constexpr int knobCount = KnobRes + 1;
+    static_assert(MuxKnob_1 == 0 && knobCount == PANEL_KNOB_COUNT, "The schema knob column follows this knob order");
+    KnobConditioner knobConditioners[knobCount];
+    uint32_t nowMs = 0;
     
     PolyAnalogDSP polySynth;
+    PresetCache presetCache;
 
     bool shiftState = false;
+    
+    bool hidSettling = false;
+    uint32_t hidSettleStartMs = 0;
 };
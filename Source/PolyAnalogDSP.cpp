@@ -9,54 +9,31 @@
 */
 
 #include "PolyAnalogDSP.h"
+#include "RealtimeCheck.h"
 
 
-#define DECLARE_LFO(_name, _label) \
-{LfoType##_name,        _label " Lfo Type"}, \
-{LfoDestination##_name, _label " Lfo Destination"}, \
-{LfoRate##_name,        _label " Lfo Rate"}, \
-{LfoAmount##_name,      _label " Lfo Amount"}
+#define PARAMETER_DESC(_id, _name, ...) {_id, _name},
+
+static_assert(PolyAnalogDSP::Count == parameterCount, "The enum and the schema must match");
+static_assert(PolyAnalogDSP::LfoAmountB + 1 == LEGACY_PRESET_SIZE, "Legacy presets end with the LFOs");
 
 PolyAnalogDSP::PolyAnalogDSP()
 : DSPKernel({
-    {PlayMode,      "Play Mode"},
-    {Glide,         "Glide"},
-    
-    {Volume,        "Volume"},
-    
-    {OscWaveformA,      "OscWaveformA"},
-    {OscOctaveA,        "OscOctaveA"},
-    
-    {OscWaveformB,    "OscWaveformB"},
-    {OscTuneB,        "OscTuneB"},
-    {OscNoise,        "OscNoise"},
-    
-    {OscMix,        "OscMix"},
-    
-    {FilterCutoff,     "FilterCutoff"},
-    {FilterRes,        "FilterRes"},
-    {FilterEnv,        "FilterEnv"},
-    
-    {Attack,         "Attack"},
-    {Decay,          "Decay"},
-    {Sustain,        "Sustain"},
-    {HighPass,        "HighPass"},
-    
-    {LfoTypeA,          "LfoTypeA"},
-    {LfoDestinationA,   "LfoDestinationA"},
-    {LfoRateA,          "LfoRateA"},
-    {LfoAmountA,        "LfoAmountA"},
-    
-    {LfoTypeB,          "LfoTypeB"},
-    {LfoDestinationB,   "LfoDestinationB"},
-    {LfoRateB,          "LfoRateB"},
-    {LfoAmountB,        "LfoAmountB"}
-    
+    POLYANALOG_PARAMETERS(PARAMETER_DESC)
 }){
 #if defined _SIMULATOR_
     std::cout << getParameterCount() << " parameters" << std::endl;
     
 #endif
+    controlMap.clear(Count);
+    for (int i = 0; i < Count; i++) {
+        controlMap.map(parameterSchema[i].cc, i);
+    }
+    
+    // Only stored until init applies them, a host may set values before that
+    for (int i = 0; i < Count; i++) {
+        setParameterValue(i, parameterDefault(i));
+    }
 }
 
 PolyAnalogDSP::~PolyAnalogDSP() {
@@ -66,37 +43,66 @@ void PolyAnalogDSP::init(int channelCount, double sampleRate) {
     DSPKernel::init(channelCount, sampleRate);
 
     synth.init(sampleRate);
+    synth.setTrace(&trace);
+    usPerFrame = 1000000.f / sampleRate;
     
     lfo[0].init(sampleRate);
     lfo[1].init(sampleRate);
     
-    hpFilter.Init(sampleRate);
-    hpFilter.SetHighpass(10);
+    arpeggiator.init(sampleRate);
+    
+    masterBus.init(sampleRate);
+    const bool ownsEffectsMemory = effectsMemory == nullptr || effectsMemory == effectsStorage.data();
+    if (ownsEffectsMemory) { // Sized for this sample rate
+        effectsStorage.assign(MasterBus::effectsMemoryFor(sampleRate), 0.f);
+        effectsMemory = effectsStorage.data();
+        effectsMemorySize = effectsStorage.size();
+    }
+    masterBus.initEffects(effectsMemory, effectsMemorySize);
     
-    //It could be nice to initialize every parameters at first launch
-    setParameterValue(LfoDestinationA, 0.4f);
-    setParameterValue(LfoDestinationB, 0.75f);
+    declickStep = 1.f / (declickTime * sampleRate);
+    glideStepPerFrame = 1.f / (PARAMETER_GLIDE_TIME * sampleRate);
+    
+    // Every value as it stands, the defaults on first launch. A re-init (a
+    // new sample rate on a host) keeps the state and automation it had.
+    for (int i = 0; i < Count; i++) {
+        applyParameter(i, getValue(i));
+    }
+    
+    // Glides start where they are
+    for (int k = 0; k < glideParameters.count; k++) {
+        const int i = glideParameters.parameters[k];
+        glideTargets[i] = glideValues[i] = getValue(i);
+    }
+    anyGlidePending = false;
+    prepared = true;
 }
 
 void PolyAnalogDSP::processMIDI(MIDIMessageType messageType, int channel, int dataA, int dataB) {
+    REALTIME_SCOPE;
     DSPKernel::processMIDI(messageType, channel, dataA, dataB);
     
     switch (messageType) {
-        case MIDIMessageType::kNoteOn : {
-            synth.setNote(true, Note(dataA, dataB, timeStamp++));
-        }
+        case MIDIMessageType::kNoteOn :
+            noteQueue.push({ NoteEvent::NoteOn, (uint8_t)dataA, (uint8_t)dataB });
             break;
-        case MIDIMessageType::kNoteOff : {
-            synth.setNote(false, Note(dataA, 0, 0));
-        }
+        case MIDIMessageType::kNoteOff :
+            noteQueue.push({ NoteEvent::NoteOff, (uint8_t)dataA, 0 });
             break;
         case MIDIMessageType::kControlChange : {
             if (dataA == 1 /* mod wheel */) {
+#if MORPH_ON_MOD_WHEEL
+                setMorphPosition(dataB/127.f);
+#else
                 synth.setModWheel(dataB/127.f);
+#endif
             } else {
-                int parameterIndex = dataA - MIDI_CC_START;
-                if (parameterIndex >= 0 && parameterIndex < getParameterCount()) {
-                    setParameterValue(parameterIndex,dataB);
+                int parameterIndex;
+                float value;
+                if (controlMap.process(dataA, dataB, parameterIndex, value) && parameterIndex < Count) {
+                    controlValues[parameterIndex] = value;
+                    controlPending[parameterIndex] = true;
+                    anyControlPending = true;
                 }
             }
         }
@@ -119,6 +125,74 @@ void PolyAnalogDSP::processMIDI(MIDIMessageType messageType, int channel, int da
     }
 }
 
+// Clock, start, continue and stop, as the raw status byte
+void PolyAnalogDSP::processMIDIRealtime(uint8_t status) {
+    arpeggiator.processRealtime(status);
+}
+
+// Every key up, held or arpeggiated
+void PolyAnalogDSP::allNotesOff() {
+    noteQueue.push({ NoteEvent::AllNotesOff, 0, 0 });
+}
+
+// One step per sub block towards each target, snapped once close enough
+void PolyAnalogDSP::processGlides(int frameCount) {
+    if (!anyGlidePending) {
+        return;
+    }
+    const float step = 1.f - expf(-frameCount * glideStepPerFrame);
+    anyGlidePending = false;
+    for (int k = 0; k < glideParameters.count; k++) {
+        const int i = glideParameters.parameters[k];
+        const float delta = glideTargets[i] - glideValues[i];
+        if (delta == 0.f) {
+            continue;
+        }
+        glideValues[i] = fabsf(delta) < glideSnap ? glideTargets[i] : glideValues[i] + delta * step;
+        applyParameter(i, glideValues[i]);
+        anyGlidePending |= glideValues[i] != glideTargets[i];
+    }
+}
+
+// Keys received since the last block, the arpeggiator takes them when it runs
+void PolyAnalogDSP::processNotes() {
+    NoteEvent event;
+    while (noteQueue.pop(event)) {
+        switch (event.type) {
+            case NoteEvent::NoteOn :
+                if (arpeggiator.noteOn(event.pitch, event.velocity)) {
+                    break;
+                }
+                trace.write(Trace_NoteOn, event.pitch, event.velocity);
+                synth.setNote(true, Note(event.pitch, event.velocity, timeStamp++));
+                break;
+            case NoteEvent::NoteOff :
+                if (arpeggiator.noteOff(event.pitch)) {
+                    break;
+                }
+                trace.write(Trace_NoteOff, event.pitch);
+                synth.setNote(false, Note(event.pitch, 0, 0));
+                break;
+            case NoteEvent::AllNotesOff :
+                arpeggiator.releaseAll();
+                synth.allNotesOff();
+                break;
+        }
+    }
+}
+
+void PolyAnalogDSP::fireArpeggiatorEvents() {
+    arpeggiator.fireDueEvents([this](bool isNoteOn, int pitch, int velocity) {
+        if (isNoteOn) {
+            trace.write(Trace_NoteOn, pitch, velocity);
+            synth.setNote(true, Note(pitch, velocity, timeStamp++));
+        } else {
+            trace.write(Trace_NoteOff, pitch);
+            synth.setNote(false, Note(pitch, 0, 0));
+        }
+    });
+}
+
 void PolyAnalogDSP::togglePlayMode() {
     auto playModeParam = getParameter(PlayMode);
     float fValue = playModeParam->getValue();
@@ -127,23 +201,178 @@ void PolyAnalogDSP::togglePlayMode() {
     setParameterValue(PlayMode, iValue * 0.5f);
 }
 
+// Called from the main loop, the audio block won't read the preset while it's being copied
+void PolyAnalogDSP::stagePreset(const float* values) {
+    presetAccess.beginWrite();
+    for (int i = 0; i < Count; i++) {
+        stagedPreset[i] = values[i];
+    }
+    presetStaged.store(true, std::memory_order_relaxed);
+    presetAccess.endWrite();
+}
+
+// False once the audio block has committed the last staged preset
+bool PolyAnalogDSP::hasStagedPreset() const {
+    return presetStaged.load(std::memory_order_acquire);
+}
+
+EventTrace& PolyAnalogDSP::getTrace() {
+    return trace;
+}
+
+ControlMap& PolyAnalogDSP::getControlMap() {
+    return controlMap;
+}
+
+// A controller sweep only costs one fan-out per parameter per block, with the last value
+void PolyAnalogDSP::processControls() {
+    if (!anyControlPending) {
+        return;
+    }
+    for (int i = 0; i < Count; i++) {
+        if (controlPending[i]) {
+            controlPending[i] = false;
+            setParameterValue(i, controlValues[i]);
+        }
+    }
+    anyControlPending = false;
+}
+
+void PolyAnalogDSP::getPreset(float* values) {
+    for (int i = 0; i < Count; i++) {
+        values[i] = getParameter(i)->getUIValue();
+    }
+}
+
+bool PolyAnalogDSP::stagedPresetNeedsDeclick() {
+    for (int i = 0; i < Count; i++) {
+        if (isDiscreteParameter(i) && stagedPreset[i] != getParameter(i)->getUIValue()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs at block start so a block never renders half of each preset
+void PolyAnalogDSP::processStagedPreset() {
+    if (!presetStaged.load(std::memory_order_acquire) || !presetAccess.tryRead()) {
+        return;
+    }
+    if (declickGain > 0.f && stagedPresetNeedsDeclick()) {
+        declickTarget = 0.f; // Fade out first, commit once silent
+        presetAccess.endRead();
+        return;
+    }
+    
+    uint16_t changed = 0;
+    for (int i = 0; i < Count; i++) {
+        if (stagedPreset[i] != getParameter(i)->getUIValue()) {
+            setParameterValue(i, stagedPreset[i]);
+            changed++;
+        }
+    }
+    trace.write(Trace_PresetLoad, 0, changed);
+    presetStaged.store(false, std::memory_order_relaxed);
+    presetAccess.endRead();
+    declickTarget = 1.f;
+}
+
+// Called from the main loop, the audio block won't read a slot while it's being copied
+void PolyAnalogDSP::setMorphPreset(MorphSlot slot, const float* values) {
+    morphAccess.beginWrite();
+    
+    for (int i = 0; i < Count; i++) {
+        morphPresets[slot][i] = values[i];
+    }
+    morphSlotReady[slot] = true;
+    
+    if (slot == MorphA) {
+        // Preset A is what's currently loaded
+        for (int i = 0; i < Count; i++) {
+            morphApplied[i] = values[i];
+        }
+        morphPosition.store(0.f, std::memory_order_relaxed);
+        morphAppliedPosition = 0.f;
+    }
+    
+    morphEnabled.store(morphSlotReady[MorphA] && morphSlotReady[MorphB], std::memory_order_relaxed);
+    morphAccess.endWrite();
+}
+
+void PolyAnalogDSP::setMorphPosition(float position) {
+    morphPosition.store(fclamp(position, 0.f, 1.f), std::memory_order_relaxed);
+}
+
+float PolyAnalogDSP::getMorphPosition() const {
+    return morphPosition.load(std::memory_order_relaxed);
+}
+
+void PolyAnalogDSP::processMorph() {
+    if (!morphEnabled.load(std::memory_order_acquire)) {
+        return;
+    }
+    const float position = morphPosition.load(std::memory_order_relaxed);
+    if (position == morphAppliedPosition || !morphAccess.tryRead()) {
+        return;
+    }
+    
+    const float* presetA = morphPresets[MorphA];
+    const float* presetB = morphPresets[MorphB];
+    
+    for (int i = 0; i < Count; i++) {
+        float value;
+        if (isDiscreteParameter(i)) {
+            value = position < morphThreshold ? presetA[i] : presetB[i];
+        } else {
+            value = presetA[i] + (presetB[i] - presetA[i]) * position;
+        }
+        // Only re-apply what actually moved
+        if (value != morphApplied[i]) {
+            morphApplied[i] = value;
+            setParameterValue(i, value);
+        }
+    }
+    morphAppliedPosition = position;
+    morphAccess.endRead();
+}
+
+// Glide parameters only take a target here, processGlides eases them in
 void PolyAnalogDSP::updateParameter(int index, float value) {
+    if (!prepared) { // init applies it
+        return;
+    }
+    if (parameterSchema[index].smooth == Smooth_Glide) {
+        glideTargets[index] = value;
+        anyGlidePending = true;
+        return;
+    }
+    applyParameter(index, value);
+}
+
+void PolyAnalogDSP::applyParameter(int index, float value) {
     auto param = static_cast<Parameters>(index);
+    const float mapped = mapParameter(index, value);
     switch (param) {
-        case PlayMode :
-            synth.setPolyMode(static_cast<PolySynth::EPolyMode>(valueMap(value, 0, 2)));
+        case PlayMode : {
+                auto mode = static_cast<PolySynth::EPolyMode>(mapped);
+                trace.write(Trace_PlayMode, mode);
+                synth.setPolyMode(mode);
+            }
+            break;
+        case Volume :
+            volume = mapped;
             break;
         case OscWaveformA :
             synth.setWaveform(0, value);
             break;
         case OscOctaveA :
-            synth.setOctave(valueMap(value, -2, 2));
+            synth.setOctave(mapped);
             break;
         case OscWaveformB :
             synth.setWaveform(1, value);
             break;
         case OscTuneB :
-            synth.setOscBTune(valueMap(value, 0, SynthVoice::btuneCount - 1));
+            synth.setOscBTune(mapped);
             break;
         case OscNoise :
             synth.setNoiseMix(value);
@@ -152,20 +381,110 @@ void PolyAnalogDSP::updateParameter(int index, float value) {
             synth.setOscMix(value);
             break;
         case FilterCutoff :
-            synth.setFilterMidiFreq((value * 120.f) + 15.f);
-            break;
-        case HighPass :
-            hpFilter.SetHighpass(fast_mtof((value * 120.f) + 15.f));
+            synth.setFilterMidiFreq(mapped);
             break;
-        case FilterRes : {
-                float qvalue = std::exp(value * lnRatio);
-                synth.setFilterRes(qvalue);
+        case HighPass : {
+                masterBus.setHighPass(fast_mtof(mapped));
             }
             break;
+        case Spread :
+            synth.setStereoSpread(mapped);
+            break;
+        case FilterType :
+            synth.setFilterType(static_cast<SynthVoice::FilterType>(mapped));
+            break;
+        case UnisonVoices :
+            synth.setUnisonVoices(mapped);
+            break;
+        case UnisonDetune :
+            synth.setUnisonDetune(mapped);
+            break;
+        case UnisonCurve :
+            synth.setUnisonCurve(static_cast<PolySynth::EUnisonCurve>(mapped));
+            break;
+        case UnisonPhase :
+            synth.setUnisonPhase(mapped);
+            break;
+        case Velocity :
+            synth.setVelocitySensitivity(mapped);
+            break;
+        case ChorusMix :
+            masterBus.getChorus().setMix(mapped);
+            break;
+        case ChorusRate :
+            masterBus.getChorus().setRate(mapped);
+            break;
+        case ChorusDepth :
+            masterBus.getChorus().setDepth(mapped);
+            break;
+        case DelayMix :
+            masterBus.getDelay().setMix(mapped);
+            break;
+        case DelayTime :
+            masterBus.getDelay().setTime(mapped);
+            break;
+        case DelaySync :
+            masterBus.getDelay().setSync(static_cast<StereoDelay::Sync>(mapped));
+            break;
+        case DelayFeedback :
+            masterBus.getDelay().setFeedback(mapped);
+            break;
+        case Tempo :
+            masterBus.getDelay().setTempo(mapped);
+            arpeggiator.setTempo(mapped);
+            break;
+        case ArpMode :
+            arpeggiator.setMode(static_cast<Arpeggiator::Mode>(mapped));
+            break;
+        case ArpOctaves :
+            arpeggiator.setOctaves(mapped);
+            break;
+        case ArpDivision :
+            arpeggiator.setDivision(static_cast<Arpeggiator::Division>(mapped));
+            break;
+        case ArpGate :
+            arpeggiator.setGate(mapped);
+            break;
+        case ArpClock :
+            arpeggiator.setClockSource(static_cast<Arpeggiator::ClockSource>(mapped));
+            break;
+        case SeqRecord :
+            arpeggiator.setRecord(mapped > 0.5f);
+            break;
+        case FilterRes :
+            synth.setFilterRes(mapped);
+            break;
         case FilterEnv :
             synth.setFilterEnv(value);
             break;
-        case LfoDestinationA:
+        case Glide :
+            synth.setGlide(value);
+            break;
+        case Attack :
+            attack = mapped;
+            updateEnvelope();
+            break;
+        case Decay :
+            decay = mapped;
+            updateEnvelope();
+            break;
+        case Sustain :
+            sustain = mapped;
+            updateEnvelope();
+            break;
+        case LfoRateA:
+            lfo[0].setRate(value);
+            break;
+        case LfoAmountA:
+            lfo[0].setAmount(value);
+            break;
+        case LfoRateB:
+            lfo[1].setRate(value);
+            break;
+        case LfoAmountB:
+            lfo[1].setAmount(value);
+            break;
+        case LfoDestinationA: // The LFO maps its own destination
             lfo[0].setDestinationValue(value);
             break;
         case LfoDestinationB:
@@ -177,52 +496,98 @@ void PolyAnalogDSP::updateParameter(int index, float value) {
     }
 }
 
+// Times in seconds, release follows decay
+void PolyAnalogDSP::updateEnvelope() {
+    synth.setADSR(attack, decay, sustain, decay);
+}
+
+// Replaces the fixed 0.333 before the clipper, see MASTER_BUS_GAIN
+void PolyAnalogDSP::setOutputGain(float gain) {
+    masterBus.setOutputGain(gain);
+}
+
+void PolyAnalogDSP::setModeGain(PolySynth::EPolyMode mode, float gain) {
+    synth.setModeGain(mode, gain);
+}
+
+void PolyAnalogDSP::setEffectsMemory(float* memory, size_t size) {
+    effectsMemory = memory;
+    effectsMemorySize = size;
+}
+
 const char* PolyAnalogDSP::getLfoDestName(int lfoIdx) {
     auto dest = lfo[lfoIdx].getDestination();
     return lfo[lfoIdx].destinationNames[dest];
 }
 
-float PolyAnalogDSP::getLfoBuffer(int lfoIdx, Lfo::LfoDest target, uint8_t frame, float multiplier) {
+float PolyAnalogDSP::getLfoBuffer(int lfoIdx, Lfo::LfoDest target, size_t frame, float multiplier) {
     return lfo[lfoIdx].getBuffer(target, frame, multiplier);
 }
 
 void PolyAnalogDSP::process(float** buf, int frameCount) {
+    REALTIME_SCOPE;
+    const uint32_t blockStart = trace.now();
+    trace.write(Trace_BlockStart, 0, frameCount);
+    
     DSPKernel::process(buf, frameCount);
-    //TODO : move everything to updateParameter function
-    synth.setGlide(getValue(Glide));
+    processStagedPreset();
+    processMorph();
+    processControls();
+    processNotes();
     
-    lfo[0].setRate(getValue(LfoRateA));
-    lfo[0].setAmount(getValue(LfoAmountA));
-    lfo[0].process(frameCount);
+    // Sub blocks also end on arpeggiator events, so its notes start on their frame
+    int offset = 0;
+    while (offset < frameCount) {
+        fireArpeggiatorEvents();
+        int frames = std::min(frameCount - offset, MAX_BLOCK_SIZE);
+        frames = std::max(1, std::min(frames, arpeggiator.framesUntilEvent()));
+        processGlides(frames);
+        processBlock(buf, offset, frames);
+        arpeggiator.advance(frames);
+        offset += frames;
+    }
     
-    lfo[1].setRate(getValue(LfoRateB));
-    lfo[1].setAmount(getValue(LfoAmountB));
+    const uint32_t duration = trace.now() - blockStart;
+    const uint16_t durationUs = duration > 0xFFFF ? 0xFFFF : duration;
+    trace.write(Trace_BlockEnd, 0, durationUs);
+    if (duration > frameCount * usPerFrame) {
+        trace.addOverrun(durationUs);
+    }
+}
+
+void PolyAnalogDSP::processBlock(float** buf, int offset, int frameCount) {
+    lfo[0].process(frameCount);
     lfo[1].process(frameCount);
     
-    float decay = valueMapPow3(getValue(Decay), 0.005f, 8.f);
+    for (int i = 0; i < frameCount; i++) {
+        pitchLfoBuffer[i] = getLfoBuffer(0, Lfo::LfoDest_Pitch, i) + getLfoBuffer(1, Lfo::LfoDest_Pitch, i);
+        filterLfoBuffer[i] = getLfoBuffer(0, Lfo::LfoDest_FilterCutoff, i) + getLfoBuffer(1, Lfo::LfoDest_FilterCutoff, i);
+    }
     
-    synth.setADSR(valueMapPow3(getValue(Attack), 0.002f, 16.f),
-                  decay,
-                  valueMap(getValue(Sustain), 0.f, 1.f),
-                  decay);
+    float* left = mixBuffer[0];
+    float* right = mixBuffer[1];
+    synth.process(left, right, pitchLfoBuffer, filterLfoBuffer, frameCount);
     
-    synth.preprare();
+    const float declickFrom = declickGain;
+    if (declickGain != declickTarget) {
+        const float step = declickStep * frameCount;
+        declickGain = declickGain < declickTarget
+            ? fminf(declickGain + step, declickTarget)
+            : fmaxf(declickGain - step, declickTarget);
+    }
+    masterBus.process(left, right, frameCount, volume, declickFrom, declickGain);
     
-    for (int i = 0; i < frameCount; i++) {
-        //updateParameters(); // useless only for smoothed parameters
-        
-        float volume = getValue(Volume); 
-
-        synth.setPitchLfo(getLfoBuffer(0, Lfo::LfoDest_Pitch, i) + getLfoBuffer(1, Lfo::LfoDest_Pitch, i));
-        synth.setFilterLfo(getLfoBuffer(0, Lfo::LfoDest_FilterCutoff, i) + getLfoBuffer(1, Lfo::LfoDest_FilterCutoff, i));
-        
-        float out = synth.process() * volume;
-        
-        out = hpFilter.Process(out);
-       
-        buf[0][i] = SoftClip(out * 0.333);
-        for (int channel = 1; channel < channelCount; channel++) {
-            buf[channel][i] = buf[0][i];
+    if (channelCount == 1) {
+        for (int i = 0; i < frameCount; i++) {
+            buf[0][offset + i] = (left[i] + right[i]) * 0.5f;
+        }
+        return;
+    }
+    for (int channel = 0; channel < channelCount; channel++) {
+        const float* mix = mixBuffer[channel & 1];
+        float* out = buf[channel] + offset;
+        for (int i = 0; i < frameCount; i++) {
+            out[i] = mix[i];
         }
     }
 }
@@ -13,52 +13,39 @@
 #include "DaisyYMNK/DSP/DSP.h"
 #include "PolySynth.h"
 #include "Lfo.h"
+#include "ControlMap.h"
+#include "ParameterSchema.h"
+#include "MasterBus.h"
+#include "SharedAccess.h"
+#include "NoteQueue.h"
+
+#include <atomic>
+#include <vector>
 
 #include "daisysp.h"
 
 using namespace daisysp;
 using namespace ydaisy;
 
-#define MIDI_CC_START 10
+#define MORPH_ON_MOD_WHEEL 0 // 1 : mod wheel drives preset morph instead of vibrato
 
-#define LFO_PARAM(_name) \
-LfoType##_name, \
-LfoDestination##_name, \
-LfoRate##_name, \
-LfoAmount##_name
+#define PARAMETER_ENUM(_id, ...) _id,
 
 class PolyAnalogDSP : public DSPKernel {
 public:
     enum Parameters {
-        PlayMode,
-        Glide,
-        Volume,
-        
-        OscWaveformA,
-        OscOctaveA,
-        
-        OscWaveformB,
-        OscTuneB,
-        
-        OscNoise,
-        OscMix,
-        
-        FilterCutoff,
-        FilterRes,
-        FilterEnv,
-
-        Attack,
-        Decay,
-        Sustain,
-        
-        HighPass,
+        POLYANALOG_PARAMETERS(PARAMETER_ENUM)
         
-        LFO_PARAM(A),
-        LFO_PARAM(B),
-
         Count
     };
     
+    enum MorphSlot {
+        MorphA = 0,
+        MorphB,
+        
+        MorphSlot_Count
+    };
+    
 public:
     PolyAnalogDSP();
     ~PolyAnalogDSP();
@@ -67,29 +54,116 @@ public:
     virtual void init(int channelCount, double sampleRate) override;
     virtual void process(float** buf, int frameCount) override;
     virtual void processMIDI(MIDIMessageType messageType, int channel, int dataA, int dataB) override;
+    void processMIDIRealtime(uint8_t status); // Audio thread only
+    void allNotesOff();
 
     const char* getLfoDestName(int lfoIdx);
     
     void togglePlayMode();
     
+    EventTrace& getTrace();
+    ControlMap& getControlMap();
+    
+    void stagePreset(const float* values);
+    bool hasStagedPreset() const;
+    void getPreset(float* values);
+    
+    void setMorphPreset(MorphSlot slot, const float* values);
+    void setMorphPosition(float position);
+    float getMorphPosition() const;
+    
+    void setOutputGain(float gain);
+    void setModeGain(PolySynth::EPolyMode mode, float gain); // Applied at the next block
+    
+    // Delay line memory for the effects (SDRAM on the Daisy), call before init.
+    // Without it init allocates what the sample rate needs on the heap
+    // (MasterBus::effectsMemoryFor, about 557 KB at 44.1 or 48 kHz).
+    void setEffectsMemory(float* memory, size_t size);
+    
 protected:
     virtual void updateParameter(int index, float value) override;
     
 private:
-    float getLfoBuffer(int lfoIdx, Lfo::LfoDest target, uint8_t frame, float multiplier = 1.f);
+    void processBlock(float** buf, int offset, int frameCount);
+    float getLfoBuffer(int lfoIdx, Lfo::LfoDest target, size_t frame, float multiplier = 1.f);
+    void updateEnvelope();
+    void fireArpeggiatorEvents();
+    void processNotes();
+    void applyParameter(int index, float value);
+    void processGlides(int frameCount);
+    
+    void processStagedPreset();
+    bool stagedPresetNeedsDeclick();
+    void processMorph();
+    void processControls();
+    static constexpr bool isDiscreteParameter(int index) {
+        return parameterSchema[index].kind == Param_Discrete;
+    }
     
 private:
     PolySynth synth;
-    FastOnePole hpFilter;
+    Arpeggiator arpeggiator;
+    MasterBus masterBus;
+    float* effectsMemory = nullptr;
+    size_t effectsMemorySize = 0;
+    std::vector<float> effectsStorage;
+    
+    float pitchLfoBuffer[MAX_BLOCK_SIZE];
+    float filterLfoBuffer[MAX_BLOCK_SIZE];
+    float mixBuffer[2][MAX_BLOCK_SIZE];
     
     static constexpr uint8_t lfoCount = 2;
     const float multipliers[5] = { 0.001f, 0.01f, 0.1f, 1.f, 10.f };
     
     Lfo lfo[lfoCount];
     
+    float attack = 0.f;
+    float decay = 0.f;
+    float sustain = 0.f;
+    
     unsigned long timeStamp = 0;
-    static constexpr float Qmin = 0.25f;
-    static constexpr float Qmax = 8.0f;
-    float lnRatio = std::log(Qmax / Qmin);
+    
+    // Keys only land here, the audio block plays them
+    NoteQueue noteQueue;
+    
+    EventTrace trace;
+    
+    // CCs only land here, each parameter is applied at most once per block
+    ControlMap controlMap;
+    float controlValues[Count];
+    bool controlPending[Count] = {};
+    bool anyControlPending = false;
+    
+    float usPerFrame = 0.f;
+    bool prepared = false; // Parameter values are only stored until init
+    
+    // Glide parameters (see ParameterSchema.h) : the target set, the value applied so far
+    float glideTargets[Count];
+    float glideValues[Count];
+    bool anyGlidePending = false;
+    float glideStepPerFrame = 0.f;
+    static constexpr float glideSnap = 0.0005f;
+    float volume = 0.f;
+    
+    // Preset written by the main loop, committed by the audio block
+    float stagedPreset[Count];
+    std::atomic<bool> presetStaged {false};
+    SharedAccess presetAccess;
+    
+    // Masks discontinuous parameter changes
+    static constexpr float declickTime = 0.002f;
+    float declickStep = 0.f;
+    float declickGain = 1.f;
+    float declickTarget = 1.f;
+    
+    // Both morph presets live here, the audio block only reads them
+    float morphPresets[MorphSlot_Count][Count];
+    float morphApplied[Count];
+    bool morphSlotReady[MorphSlot_Count] = { false, false };
+    std::atomic<bool> morphEnabled {false};
+    std::atomic<float> morphPosition {0.f};
+    SharedAccess morphAccess;
+    float morphAppliedPosition = 0.f;
+    static constexpr float morphThreshold = 0.5f;
 
 };
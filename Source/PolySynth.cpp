@@ -14,9 +14,14 @@ PolySynth::PolySynth() {
     for (size_t i = 0; i < VOICE_COUNT; i++) {
         voices.push_back(new SynthVoice());
     }
+    // setNote runs in the audio path, it must never grow this
+    noteState.reserve(maxHeldNotes);
 }
 
 PolySynth::~PolySynth() {
+#if POLYSYNTH_THREADS
+    workers.stop();
+#endif
     for (auto v : voices)
     {
         delete v;
@@ -24,72 +29,181 @@ PolySynth::~PolySynth() {
     voices.clear();
 }
 
+int PolySynth::getVoiceCount() {
+    switch (polyMode) {
+        case Unison:
+            return unisonVoiceCount;
+        case Poly:
+            return VOICE_COUNT;
+        case Mono:
+        default:
+            return 1;
+    }
+}
+
+// Equal power, unity gain at center so a zero spread sounds like the mono output
+void PolySynth::updatePan() {
+    const int voiceCount = getVoiceCount();
+    const float modeGain = modeGains[polyMode];
+    
+    for (int i = 0; i < VOICE_COUNT; i++) {
+        float position = 0.f;
+        if (voiceCount > 1 && i < voiceCount) {
+            position = ((2.f * i) / (voiceCount - 1) - 1.f) * stereoSpread;
+        }
+        const float angle = (position + 1.f) * (float)M_PI_4;
+        panGains[i][0] = cosf(angle) * (float)M_SQRT2 * modeGain;
+        panGains[i][1] = sinf(angle) * (float)M_SQRT2 * modeGain;
+    }
+}
+
+// Pitch offset of every layer, only recomputed when a unison setting changes
+void PolySynth::updateUnison() {
+    for (int i = 0; i < VOICE_COUNT; i++) {
+        float position = 0.f;
+        if (unisonVoiceCount > 1 && i < unisonVoiceCount) {
+            position = (2.f * i) / (unisonVoiceCount - 1) - 1.f;
+        }
+        switch (unisonCurve) {
+            case UnisonCenter:
+                position = position * fabsf(position);
+                break;
+            case UnisonEdges:
+                position = copysignf(sqrtf(fabsf(position)), position);
+                break;
+            case UnisonLinear:
+            default:
+                break;
+        }
+        unisonOffsets[i] = position * unisonDetune;
+    }
+}
+
+float PolySynth::nextRandom() {
+    randomSeed = randomSeed * 1664525u + 1013904223u;
+    return (randomSeed >> 8) * (1.f / 16777216.f);
+}
+
 void PolySynth::init(double sampleRate)  {
+    cutoffTable.init(sampleRate);
+    envelopeShape.init(sampleRate);
     for (auto v : voices)
     {
-        v->init(sampleRate);
+        v->init(sampleRate, &cutoffTable, &envelopeShape);
     }
     modulation.Init(sampleRate);
     modulation.SetFreq(8);
     whiteNoise.Init();
     whiteNoise.SetAmp(0.707f);
+    
+#if POLYSYNTH_THREADS
+    for (auto& partition : partitions) {
+        partition.noise.Init();
+        partition.noise.SetAmp(0.707f);
+    }
+#endif
+    
+    updateUnison();
+    updatePan();
 }
 
-void PolySynth::setNote(bool isNoteOn, Note note) {
+// Mono and unison are monophonic : layer i always plays on voice i. A layer
+// keeps its voice from note to note so it glides from its own last pitch and
+// falls back to the last held note in place. Taking whatever voices are free
+// would restart each layer's glide from another note and spread a stack over
+// voices that still hold the previous one's release.
+template <PolySynth::EPolyMode mode>
+void PolySynth::noteOn(Note note) {
+    if (mode != Poly) {
+        const int voiceCount = mode == Unison ? unisonVoiceCount : 1;
+        for (int i = 0; i < voiceCount; i++)
+        {
+            if (mode == Unison) {
+                voices[i]->setStartPhase(nextRandom() * unisonPhase);
+            }
+            voices[i]->setNoteOn(note);
+        }
+        return;
+    }
     
-    int voiceCount = 1;
-    switch (polyMode) {
-        case Mono:
-            voiceCount = 1;
-            break;
-        case Unison:
-            voiceCount = UNISON_VOICE_COUNT;
-            break;
-        case Poly:
-            voiceCount = VOICE_COUNT;
-            break;
-            
-        default:
-            break;
+    // Polyphonic part
+    //This is wrong
+    /*for (int i = 0; i < VOICE_COUNT; i++)
+    {
+        if (voices.at(i)->currentPitch() == note.pitch) {
+            voices.at(i)->setNoteOn(note);
+            return;
+        }
+    }*/
+    
+    for (int i = 0; i < VOICE_COUNT; i++)
+    {
+        if (!voices[i]->isPlaying()) {
+            voices[i]->setNoteOn(note);
+            traceVoice(Trace_VoiceAlloc, i, note.pitch);
+            return;
+        }
+    }
+    
+    // Steal the quietest released voice, or else the oldest one
+    int stolen = -1;
+    for (int i = 0; i < VOICE_COUNT; i++)
+    {
+        if (!voices[i]->isGateOn() && (stolen < 0 || voices[i]->getLevel() < voices[stolen]->getLevel())) {
+            stolen = i;
+        }
+    }
+    if (stolen < 0) {
+        stolen = 0;
+        for (int i = 0; i < VOICE_COUNT; i++)
+        {
+            if (voices[i]->noteTimeStamp < voices[stolen]->noteTimeStamp) {
+                stolen = i;
+            }
+        }
+    }
+    
+    voices[stolen]->setNoteOn(note);
+    traceVoice(Trace_VoiceSteal, stolen, note.pitch);
+}
+
+template <PolySynth::EPolyMode mode>
+void PolySynth::noteOff(Note note) {
+    const int voiceCount = mode == Poly ? VOICE_COUNT : (mode == Unison ? unisonVoiceCount : 1);
+    
+    // Mono and unison fall back to the last held note
+    if (mode != Poly && noteState.size()) {
+        for (int i = 0; i < voiceCount; i++)
+        {
+            if (voices[i]->currentPitch() != noteState.back().pitch) {
+                voices[i]->setNoteOn(noteState.back());
+            }
+        }
+        return;
+    }
+    
+    for (int i = 0; i < voiceCount; i++)
+    {
+        if (voices[i]->currentPitch() == note.pitch && voices[i]->isPlaying()) {
+            voices[i]->setNoteOff();
+        }
     }
+}
 
+void PolySynth::setNote(bool isNoteOn, Note note) {
+    
     if (isNoteOn) {
         
-        noteState.push_back(note);
-        
-        if (polyMode != Poly) {
-            for (int i = 0; i < voiceCount; i++)
-            {
-                voices.at(i)->setNoteOn(note);
-            }
-        } else { // Polyphonic part
-            //This is wrong
-            /*for (int i = 0; i < voiceCount; i++)
-            {
-                if (voices.at(i)->currentPitch() == note.pitch) {
-                    voices.at(i)->setNoteOn(note);
-                    return;
-                }
-            }*/
-            
-            for (int i = 0; i < voiceCount; i++)
-            {
-                if (!voices.at(i)->isPlaying()) {
-                    voices.at(i)->setNoteOn(note);
-                    return;
-                }
+        for (auto nIt = noteState.begin(); nIt != noteState.end(); nIt++) {
+            if (nIt->pitch == note.pitch) { // Retriggered, moves to the top
+                noteState.erase(nIt);
+                break;
             }
-            
-            SynthVoice* oldest = voices.front();
-            for (int i = 0; i < voiceCount; i++)
-            {
-                if (voices.at(i)->noteTimeStamp < oldest->noteTimeStamp) {
-                    oldest = voices.at(i);
-                }
-            }
-            
-            oldest->setNoteOn(note);
         }
+        if (noteState.size() == maxHeldNotes) { // Out of range pitches only, never reallocate
+            noteState.erase(noteState.begin());
+        }
+        noteState.push_back(note);
     } else {
         auto nIt = noteState.begin();
         
@@ -100,29 +214,38 @@ void PolySynth::setNote(bool isNoteOn, Note note) {
                 nIt++;
             }
         }
-        
-        bool sendNoteOff = true;
-        
-        if (polyMode != Poly) {
-            if (noteState.size()) {
-                for (int i = 0; i < voiceCount; i++)
-                {
-                    if (voices.at(i)->currentPitch() != noteState.back().pitch) {
-                        voices.at(i)->setNoteOn(noteState.back());
-                    }
-                    sendNoteOff = false;
-                }
-            }
-        }
-        
-        if (sendNoteOff) {
-            for (int i = 0; i < voiceCount; i++)
-            {
-                if (voices.at(i)->currentPitch() == note.pitch && voices.at(i)->isPlaying()) {
-                    voices.at(i)->setNoteOff();
-                }
-            }
-        }
+    }
+    
+    // The only play mode test on the note path
+    switch (polyMode) {
+        case Unison:
+            isNoteOn ? noteOn<Unison>(note) : noteOff<Unison>(note);
+            break;
+        case Poly:
+            isNoteOn ? noteOn<Poly>(note) : noteOff<Poly>(note);
+            break;
+        case Mono:
+        default:
+            isNoteOn ? noteOn<Mono>(note) : noteOff<Mono>(note);
+            break;
+    }
+}
+
+void PolySynth::allNotesOff() {
+    noteState.clear();
+    for (auto v : voices)
+    {
+        v->setNoteOff();
+    }
+}
+
+void PolySynth::setTrace(EventTrace* trace) {
+    this->trace = trace;
+}
+
+void PolySynth::traceVoice(TraceEventType type, int voice, int pitch) {
+    if (trace) {
+        trace->write(type, voice, pitch);
     }
 }
 
@@ -134,12 +257,51 @@ void PolySynth::setModWheel(float value) {
     this->vibratoAmount.setValue(value);
 }
 
-void PolySynth::setPitchLfo(float tune) {
-    this->pitchLfoMod = tune * 24.f;
+void PolySynth::setStereoSpread(float spread) {
+    if (spread != stereoSpread) {
+        stereoSpread = spread;
+        updatePan();
+    }
 }
 
-void PolySynth::setFilterLfo(float f) {
-    this->filterLfoMod = f * 50.f;
+// Level of each play mode, folded into the pan gains at the next block
+void PolySynth::setModeGain(EPolyMode mode, float gain) {
+    requestedModeGains[mode].store(gain, std::memory_order_relaxed);
+    modeGainPending.store(true, std::memory_order_release);
+}
+
+void PolySynth::setUnisonVoices(int voiceCount) {
+    voiceCount = std::max(1, std::min(voiceCount, VOICE_COUNT));
+    if (voiceCount == unisonVoiceCount) {
+        return;
+    }
+    if (polyMode == Unison) {
+        for (int i = voiceCount; i < unisonVoiceCount; i++) {
+            voices[i]->setNoteOff();
+        }
+    }
+    unisonVoiceCount = voiceCount;
+    updateUnison();
+    updatePan();
+}
+
+void PolySynth::setUnisonDetune(float semitones) {
+    if (semitones != unisonDetune) {
+        unisonDetune = semitones;
+        updateUnison();
+    }
+}
+
+void PolySynth::setUnisonCurve(EUnisonCurve curve) {
+    if (curve != unisonCurve) {
+        unisonCurve = curve;
+        updateUnison();
+    }
+}
+
+// 0 : every layer starts in phase, 1 : fully random start phases
+void PolySynth::setUnisonPhase(float randomAmount) {
+    unisonPhase = randomAmount;
 }
 
 void PolySynth::setPolyMode(EPolyMode newPolyMode) {
@@ -149,6 +311,7 @@ void PolySynth::setPolyMode(EPolyMode newPolyMode) {
         {
             voices[i]->setNoteOff();
         }
+        updatePan();
     }
 }
 
@@ -188,17 +351,20 @@ void PolySynth::setOscMix(float mix) {
 }
 
 void PolySynth::setNoiseMix(float mix) {
+    noiseOn = mix > 0.f;
     for (auto v : voices)
     {
         v->setNoiseMix(mix);
     }
 }
 
+// Shared by every voice, nothing to fan out
 void PolySynth::setADSR(float attack, float decay, float sustain, float release) {
-    for (auto v : voices)
-    {
-        v->setADSR(attack, decay, sustain, release);
-    }
+    envelopeShape.setADSR(attack, decay, sustain, release);
+}
+
+void PolySynth::setVelocitySensitivity(float amount) {
+    envelopeShape.setVelocitySensitivity(amount);
 }
 
 void PolySynth::setFilterMidiFreq(float freq) {
@@ -219,38 +385,133 @@ void PolySynth::setFilterEnv(float env) {
         v->setFilterEnv(env);
     }
 }
-
-void PolySynth::preprare() {
+void PolySynth::setFilterType(SynthVoice::FilterType type) {
     for (auto v : voices)
     {
-        v->prepare();
+        v->setFilterType(type);
     }
 }
 
-float PolySynth::process() {
-    float pitchMod = 0;
+void PolySynth::process(float* left, float* right, const float* pitchLfo, const float* filterLfo, size_t frameCount) {
+    envelopeShape.update();
+    if (modeGainPending.exchange(false, std::memory_order_acquire)) {
+        for (int mode = Mono; mode <= Poly; mode++) {
+            modeGains[mode] = requestedModeGains[mode].load(std::memory_order_relaxed);
+        }
+        updatePan();
+    }
     
-    float result = 0;
-    float idx = 0;
+    for (size_t i = 0; i < frameCount; i++) {
+        bend.dezipperCheck(smoothGlobal);
+        vibratoAmount.dezipperCheck(smoothGlobal);
+        pitchModBuffer[i] = pitchLfo[i] * 24.f + bend.getAndStep() + modulation.Process() * vibratoAmount.getAndStep();
+        filterModBuffer[i] = filterLfo[i] * 50.f;
+        
+        left[i] = 0.f;
+        right[i] = 0.f;
+    }
     
-    bend.dezipperCheck(smoothGlobal);
-    vibratoAmount.dezipperCheck(smoothGlobal);
-    pitchMod = pitchLfoMod + bend.getAndStep() + modulation.Process() * vibratoAmount.getAndStep();
+#if POLYSYNTH_THREADS
+    const int threadCount = workers.getThreadCount();
+    if (threadCount > 1) {
+        int activeVoiceCount = 0;
+        for (auto v : voices) {
+            activeVoiceCount += v->isPlaying();
+        }
+        if (activeVoiceCount >= threadingThreshold) {
+            blockFrameCount = frameCount;
+            workers.run();
+            
+            // Partition 0 is the audio thread itself
+            for (int partition = 0; partition < threadCount; partition++) {
+                const float* partLeft = partitions[partition].left;
+                const float* partRight = partitions[partition].right;
+                for (size_t i = 0; i < frameCount; i++) {
+                    left[i] += partLeft[i];
+                    right[i] += partRight[i];
+                }
+            }
+            return;
+        }
+    }
+#endif
+    
+    renderVoices(0, 1, left, right, whiteNoise, voiceBuffer, frameCount);
+}
 
-    for (auto v : voices)
+// One play mode test per block, each mode then runs its own loops
+void PolySynth::renderVoices(int first, int step, float* left, float* right, WhiteNoise& noise, float* scratch, size_t frameCount) {
+    switch (polyMode) {
+        case Unison:
+            renderMode<Unison>(first, step, left, right, noise, scratch, frameCount);
+            break;
+        case Poly:
+            renderMode<Poly>(first, step, left, right, noise, scratch, frameCount);
+            break;
+        case Mono:
+        default:
+            renderMode<Mono>(first, step, left, right, noise, scratch, frameCount);
+            break;
+    }
+}
+
+template <PolySynth::EPolyMode mode>
+void PolySynth::renderMode(int first, int step, float* left, float* right, WhiteNoise& noise, float* scratch, size_t frameCount) {
+    for (int idx = first; idx < VOICE_COUNT; idx += step)
     {
-        v->pitchMod = pitchMod;
+        SynthVoice* v = voices[idx];
+        v->renderEnvelope(frameCount);
+        if (!v->isPlaying()) { // Asleep until its next note
+            continue;
+        }
         
-        if (polyMode == Unison) {
-            float unisonMod = -0.015625 + (idx*(0.03125/(UNISON_VOICE_COUNT-1)));
-            v->pitchMod += unisonMod;
+        if (mode == Unison) {
+            const float unisonMod = unisonOffsets[idx];
+            for (size_t i = 0; i < frameCount; i++) {
+                v->pitchMod = pitchModBuffer[i] + unisonMod;
+                scratch[i] = v->process(noiseOn ? noise.Process() : 0.f, filterModBuffer[i]);
+            }
+        } else {
+            for (size_t i = 0; i < frameCount; i++) {
+                v->pitchMod = pitchModBuffer[i];
+                scratch[i] = v->process(noiseOn ? noise.Process() : 0.f, filterModBuffer[i]);
+            }
+        }
+        
+        // Straight multiply-adds over the block so the compiler can vectorize the mix
+        if (mode == Mono) { // Centered, same gain on both sides
+            const float gain = panGains[idx][0];
+            for (size_t i = 0; i < frameCount; i++) {
+                const float out = scratch[i] * gain;
+                left[i] += out;
+                right[i] += out;
+            }
+        } else {
+            const float gainL = panGains[idx][0];
+            const float gainR = panGains[idx][1];
+            for (size_t i = 0; i < frameCount; i++) {
+                left[i] += scratch[i] * gainL;
+                right[i] += scratch[i] * gainR;
+            }
         }
-        result += v->process(whiteNoise.Process(), filterLfoMod);
-        idx++;
     }
-    if (polyMode != Mono) {
-        result *= 0.707;
+}
+
+#if POLYSYNTH_THREADS
+void PolySynth::setThreadCount(int threadCount) {
+    workers.start(this, &PolySynth::renderPartition, threadCount);
+}
+
+void PolySynth::setThreadingThreshold(int activeVoiceCount) {
+    threadingThreshold = activeVoiceCount;
+}
+
+void PolySynth::renderPartition(int partition) {
+    Partition& part = partitions[partition];
+    for (size_t i = 0; i < blockFrameCount; i++) {
+        part.left[i] = 0.f;
+        part.right[i] = 0.f;
     }
-    
-    return result;
+    renderVoices(partition, workers.getThreadCount(), part.left, part.right, part.noise, part.scratch, blockFrameCount);
 }
+#endif
@@ -10,12 +10,29 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "SynthVoice.h"
+#include "EventTrace.h"
+#include "BlockSize.h"
 #include "DaisyYMNK/Common/Common.h"
 #include "daisysp.h"
 
+#ifndef VOICE_COUNT
 #define VOICE_COUNT 4
-#define UNISON_VOICE_COUNT 3
+#endif
+#define UNISON_VOICE_COUNT 3 // Default layer count
+#define UNISON_DETUNE 0.015625f // Default outer layer detune, in semitones
+#define POLY_MODE_GAIN 0.707f // Default Unison and Poly gain, Mono is 1
+
+// Host builds only : render voices on a pool of threads
+#ifndef POLYSYNTH_THREADS
+#define POLYSYNTH_THREADS 0
+#endif
+
+#if POLYSYNTH_THREADS
+#include "VoiceWorkers.h"
+#endif
 
 using namespace std;
 using namespace daisysp;
@@ -27,6 +44,15 @@ public:
         Unison,
         Poly
     };
+    
+    // How the unison layers are laid out between -detune and +detune
+    enum EUnisonCurve {
+        UnisonLinear = 0,
+        UnisonCenter,   // Layers packed around the center pitch
+        UnisonEdges,    // Layers pushed to the outer pitches
+        
+        UnisonCurve_Count
+    };
 
 public:
     PolySynth();
@@ -35,19 +61,29 @@ public:
 public:
     void init(double sampleRate);
     void setNote(bool isNoteOn, Note note);
+    void allNotesOff();
     
-    void preprare();
-    float process();
+    void process(float* left, float* right, const float* pitchLfo, const float* filterLfo, size_t frameCount);
     
     void setPitchBend(float bend);
     void setModWheel(float value);
     void setPolyMode(EPolyMode newPolyMode);
     void setGlide(float glide);
+    void setStereoSpread(float spread);
+    void setModeGain(EPolyMode mode, float gain);
+    void setUnisonVoices(int voiceCount);
+    void setUnisonDetune(float semitones);
+    void setUnisonCurve(EUnisonCurve curve);
+    void setUnisonPhase(float randomAmount);
+    void setTrace(EventTrace* trace);
     
-    void setPitchLfo(float tune);
-    void setFilterLfo(float f);
+#if POLYSYNTH_THREADS
+    void setThreadCount(int threadCount);
+    void setThreadingThreshold(int activeVoiceCount);
+#endif
     
     void setADSR(float attack, float decay, float sustain, float release);
+    void setVelocitySensitivity(float amount);
     void setWaveform(uint8_t oscIndex, float value);
     void setOctave(int8_t octave);
     void setOscBTune(uint8_t tuneIndex);
@@ -56,21 +92,74 @@ public:
     void setFilterMidiFreq(float freq);
     void setFilterRes(float res);
     void setFilterEnv(float env);
+    void setFilterType(SynthVoice::FilterType type);
+    
+private:
+    int getVoiceCount();
+    void traceVoice(TraceEventType type, int voice, int pitch);
+    void updatePan();
+    void updateUnison();
+    float nextRandom();
+    void renderVoices(int first, int step, float* left, float* right, WhiteNoise& noise, float* scratch, size_t frameCount);
+    
+    template <EPolyMode mode>
+    void renderMode(int first, int step, float* left, float* right, WhiteNoise& noise, float* scratch, size_t frameCount);
+    template <EPolyMode mode>
+    void noteOn(Note note);
+    template <EPolyMode mode>
+    void noteOff(Note note);
+    
+#if POLYSYNTH_THREADS
+    void renderPartition(int partition);
+#endif
     
 private:
     EPolyMode polyMode = Mono;
     vector<SynthVoice*> voices;
     
-    float pitchLfoMod = 0;
-    float filterLfoMod = 0;
+    EventTrace* trace = nullptr;
+    
+    float stereoSpread = 0;
+    bool noiseOn = false; // The noise generator only runs when a voice hears it
+    float panGains[VOICE_COUNT][2];
+    float modeGains[3] = { 1.f, POLY_MODE_GAIN, POLY_MODE_GAIN };
+    std::atomic<float> requestedModeGains[3] = { {1.f}, {POLY_MODE_GAIN}, {POLY_MODE_GAIN} };
+    std::atomic<bool> modeGainPending {false};
+    
+    int unisonVoiceCount = UNISON_VOICE_COUNT;
+    float unisonDetune = UNISON_DETUNE;
+    EUnisonCurve unisonCurve = UnisonLinear;
+    float unisonPhase = 0;
+    float unisonOffsets[VOICE_COUNT];
+    uint32_t randomSeed = 1;
+    
+    float pitchModBuffer[MAX_BLOCK_SIZE];
+    float filterModBuffer[MAX_BLOCK_SIZE];
+    float voiceBuffer[MAX_BLOCK_SIZE];
     
     SmoothValue bend;
     SmoothValue vibratoAmount;
     
     Oscillator modulation;
     WhiteNoise whiteNoise;
+    SvfCutoffTable cutoffTable;
+    EnvelopeShape envelopeShape;
     
     vector<Note> noteState;
+    static constexpr size_t maxHeldNotes = 128; // Every MIDI note, a key held twice is listed once
     
     static constexpr int smoothGlobal = 800;
+    
+#if POLYSYNTH_THREADS
+    struct Partition {
+        float left[MAX_BLOCK_SIZE];
+        float right[MAX_BLOCK_SIZE];
+        float scratch[MAX_BLOCK_SIZE];
+        WhiteNoise noise;
+    };
+    Partition partitions[MAX_VOICE_THREADS];
+    VoiceWorkers<PolySynth> workers;
+    int threadingThreshold = 8;
+    size_t blockFrameCount = 0;
+#endif
 };
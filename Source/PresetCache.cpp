@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    PresetCache.cpp
+    Created: 19 Oct 2026 3:54:08am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#include "PresetCache.h"
+#include "ParameterSchema.h"
+
+void PresetCache::init(PresetManager* presetManager, daisy::QSPIHandle* qspi) {
+    this->presetManager = presetManager;
+    flash.init(qspi);
+    
+    for (uint8_t slot = 0; slot < PRESET_SLOT_COUNT; slot++) {
+        fetched[slot] = false;
+        fetch(slot);
+    }
+}
+
+void PresetCache::fetch(uint8_t slot) {
+    if (fetched[slot]) {
+        return;
+    }
+    if (const PresetFlash::Record* record = flash.read(slot)) {
+        for (uint8_t k = 0; k < record->size; k++) {
+            presets[slot][k] = record->values[k];
+        }
+        fillParameterDefaults(presets[slot], record->size);
+        sizes[slot] = parameterCount;
+        valid[slot] = true;
+        fetched[slot] = true;
+        return;
+    }
+    if (presetManager == nullptr) {
+        return;
+    }
+    // PresetManager keeps no size, its presets predate the appended parameters
+    const float* data = presetManager->Load(slot);
+    valid[slot] = data != nullptr;
+    if (data) {
+        for (uint8_t k = 0; k < LEGACY_PRESET_SIZE; k++) {
+            presets[slot][k] = data[k];
+        }
+        fillParameterDefaults(presets[slot], LEGACY_PRESET_SIZE);
+        sizes[slot] = parameterCount;
+    }
+    fetched[slot] = true;
+}
+
+const float* PresetCache::load(uint8_t slot) {
+    if (slot >= PRESET_SLOT_COUNT) {
+        return nullptr;
+    }
+    fetch(slot); // Only hits the QSPI if init was skipped
+    return valid[slot] ? presets[slot] : nullptr;
+}
+
+void PresetCache::save(uint8_t slot, const float* values, uint8_t size) {
+    if (slot >= PRESET_SLOT_COUNT || size > MAX_PRESET_SIZE) {
+        return;
+    }
+    for (uint8_t k = 0; k < size; k++) {
+        presets[slot][k] = values[k];
+    }
+    sizes[slot] = size;
+    valid[slot] = true;
+    fetched[slot] = true;
+    
+    // Saving the same slot twice before it's written only costs one write
+    pendingWrite[slot] = true;
+}
+
+bool PresetCache::isWriting() {
+    if (writeStep != WriteStep_Idle) {
+        return true;
+    }
+    for (uint8_t slot = 0; slot < PRESET_SLOT_COUNT; slot++) {
+        if (pendingWrite[slot]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Takes the next pending slot, false when there is none
+bool PresetCache::beginWrite() {
+    for (uint8_t k = 0; k < PRESET_SLOT_COUNT; k++) {
+        uint8_t slot = (nextWriteSlot + k) % PRESET_SLOT_COUNT;
+        if (pendingWrite[slot]) {
+            pendingWrite[slot] = false;
+            nextWriteSlot = (slot + 1) % PRESET_SLOT_COUNT;
+            writeSlot = slot;
+            return true;
+        }
+    }
+    return false;
+}
+
+// At most one erase or one page program per call
+PresetCache::WriteStatus PresetCache::processWrites() {
+    if (!flash.isAvailable()) {
+        // No QSPI handle (simulator) : PresetManager saves the whole slot at once
+        if (presetManager == nullptr || !beginWrite()) {
+            return WriteStatus_Idle;
+        }
+        bool result = presetManager->Save(presets[writeSlot], sizes[writeSlot], writeSlot);
+        return result ? WriteStatus_Success : WriteStatus_Failed;
+    }
+    
+    if (writeStep == WriteStep_Idle) {
+        if (!beginWrite()) {
+            return WriteStatus_Idle;
+        }
+        writeRecord.magic = PresetFlash::recordMagic;
+        writeRecord.size = sizes[writeSlot];
+        for (uint8_t k = 0; k < MAX_PRESET_SIZE; k++) {
+            writeRecord.values[k] = k < sizes[writeSlot] ? presets[writeSlot][k] : 0.f;
+        }
+        if (!flash.erase(writeSlot)) {
+            return WriteStatus_Failed;
+        }
+        writeStep = WriteStep_Program;
+        writePage = PresetFlash::pageCount - 1; // The header page goes last
+        return WriteStatus_Writing;
+    }
+    
+    if (!flash.program(writeSlot, writeRecord, writePage)) {
+        writeStep = WriteStep_Idle;
+        return WriteStatus_Failed;
+    }
+    if (--writePage >= 0) {
+        return WriteStatus_Writing;
+    }
+    writeStep = WriteStep_Idle;
+    return WriteStatus_Success;
+}
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    PresetCache.h
+    Created: 19 Oct 2026 3:54:08am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "DaisyYMNK/DSP/DSP.h"
+#include "DaisyYMNK/QSPI/PresetManager.h"
+#include "PresetFlash.h"
+
+#define PRESET_SLOT_COUNT 16
+
+using namespace ydaisy;
+
+// Keeps every preset slot in RAM so a recall never touches the QSPI.
+// Saves are queued and written back by processWrites, one flash step per
+// call : the sector erase, then each page. Slots never written by the cache
+// are read through PresetManager, so older presets still load. A preset
+// saved before parameters were appended gets their schema defaults.
+class PresetCache {
+public:
+    enum WriteStatus {
+        WriteStatus_Idle = 0,
+        WriteStatus_Writing,
+        WriteStatus_Success,
+        WriteStatus_Failed
+    };
+    
+public:
+    void init(PresetManager* presetManager, daisy::QSPIHandle* qspi);
+    
+    const float* load(uint8_t slot);
+    void save(uint8_t slot, const float* values, uint8_t size);
+    
+    WriteStatus processWrites();
+    bool isWriting();
+    
+private:
+    void fetch(uint8_t slot);
+    bool beginWrite();
+    
+private:
+    enum WriteStep {
+        WriteStep_Idle = 0,
+        WriteStep_Program
+    };
+    
+    PresetManager* presetManager = nullptr;
+    PresetFlash flash;
+    
+    float presets[PRESET_SLOT_COUNT][MAX_PRESET_SIZE];
+    uint8_t sizes[PRESET_SLOT_COUNT] = {};
+    
+    bool fetched[PRESET_SLOT_COUNT] = {};
+    bool valid[PRESET_SLOT_COUNT] = {};
+    bool pendingWrite[PRESET_SLOT_COUNT] = {};
+    
+    uint8_t nextWriteSlot = 0;
+    
+    // The slot being written, copied so a save meanwhile can't tear it
+    WriteStep writeStep = WriteStep_Idle;
+    uint8_t writeSlot = 0;
+    int writePage = 0;
+    PresetFlash::Record writeRecord;
+};
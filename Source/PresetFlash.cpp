@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    PresetFlash.cpp
+    Created: 19 Oct 2026 4:50:15am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#include "PresetFlash.h"
+#include "daisy_seed.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace daisy;
+
+void PresetFlash::init(QSPIHandle* qspi) {
+    this->qspi = qspi;
+}
+
+const PresetFlash::Record* PresetFlash::read(uint8_t slot) const {
+    if (qspi == nullptr) {
+        return nullptr;
+    }
+    auto record = reinterpret_cast<const Record*>(slotAddress(slot));
+    if (record->magic != recordMagic || record->size > MAX_PRESET_SIZE) {
+        return nullptr;
+    }
+    return record;
+}
+
+// Takes the sector erase time, the longest step, unless nothing was ever
+// written there. Reading the mapped sector costs a few microseconds.
+bool PresetFlash::erase(uint8_t slot) {
+    if (qspi == nullptr) {
+        return false;
+    }
+    auto words = reinterpret_cast<const uint32_t*>(slotAddress(slot));
+    const auto end = words + PRESET_FLASH_SECTOR_SIZE / sizeof(uint32_t);
+    if (std::all_of(words, end, [](uint32_t word) { return word == 0xFFFFFFFF; })) {
+        return true;
+    }
+    return qspi->EraseSector(slotAddress(slot)) == QSPIHandle::Result::OK;
+}
+
+// One page program
+bool PresetFlash::program(uint8_t slot, const Record& record, int page) {
+    if (qspi == nullptr || page < 0 || page >= pageCount) {
+        return false;
+    }
+    const size_t offset = page * PRESET_FLASH_PAGE_SIZE;
+    const size_t size = std::min(sizeof(Record) - offset, (size_t)PRESET_FLASH_PAGE_SIZE);
+
+    uint8_t buffer[PRESET_FLASH_PAGE_SIZE];
+    memcpy(buffer, reinterpret_cast<const uint8_t*>(&record) + offset, size);
+    return qspi->Write(slotAddress(slot) + offset, size, buffer) == QSPIHandle::Result::OK;
+}
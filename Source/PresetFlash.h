@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    PresetFlash.h
+    Created: 19 Oct 2026 4:50:15am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "DaisyYMNK/QSPI/PresetManager.h"
+
+#define PRESET_FLASH_ADDRESS 0x907E0000 // Top 128 KB of the 8 MB QSPI, clear of the program and of PresetManager
+#define PRESET_FLASH_SECTOR_SIZE 4096
+#define PRESET_FLASH_PAGE_SIZE 256
+
+namespace daisy {
+    class QSPIHandle;
+}
+
+// Preset slots in the QSPI, one sector each, written in steps a caller can
+// spread over several main loop iterations : an erase, then one page per
+// call. The header page goes last, so a write cut short reads back as an
+// empty slot, never as a torn preset. The erase is the one long step :
+// QSPIHandle only offers a blocking sector erase (tens of ms), so it is
+// skipped when the sector is already blank.
+class PresetFlash {
+public:
+    struct Record {
+        uint32_t magic;
+        uint32_t size;
+        float values[MAX_PRESET_SIZE];
+    };
+
+    static constexpr uint32_t recordMagic = 0x31504150; // "PAP1"
+    static constexpr int pageCount = (sizeof(Record) + PRESET_FLASH_PAGE_SIZE - 1) / PRESET_FLASH_PAGE_SIZE;
+
+public:
+    void init(daisy::QSPIHandle* qspi);
+
+    inline bool isAvailable() const noexcept {
+        return qspi != nullptr;
+    }
+
+    // Memory mapped, nullptr when the slot holds no record
+    const Record* read(uint8_t slot) const;
+
+    bool erase(uint8_t slot);
+    bool program(uint8_t slot, const Record& record, int page);
+
+private:
+    static uint32_t slotAddress(uint8_t slot) {
+        return PRESET_FLASH_ADDRESS + slot * PRESET_FLASH_SECTOR_SIZE;
+    }
+
+private:
+    daisy::QSPIHandle* qspi = nullptr;
+};
+
+static_assert(sizeof(PresetFlash::Record) <= PRESET_FLASH_SECTOR_SIZE, "A preset must fit in one sector");
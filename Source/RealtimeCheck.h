@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Created: 19 Oct 2026 4:04:31am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+// Host builds only : with REALTIME_CHECK=1 and Tools/RealtimeCheck.cpp linked
+// in, any heap allocation or lock wait inside a REALTIME_SCOPE aborts with a
+// backtrace.
+#ifndef REALTIME_CHECK
+#define REALTIME_CHECK 0
+#endif
+
+#if REALTIME_CHECK
+
+namespace realtime {
+    void enter();
+    void leave();
+    
+    struct Scope {
+        Scope() { enter(); }
+        ~Scope() { leave(); }
+    };
+}
+
+#define REALTIME_SCOPE realtime::Scope realtimeScope
+
+#else
+
+#define REALTIME_SCOPE
+
+#endif
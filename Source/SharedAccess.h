@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    SharedAccess.h
+    Created: 19 Oct 2026 4:48:55am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Guards a buffer the main loop writes and the audio block reads. The audio
+// side never waits : tryRead fails while a write is in progress and the block
+// tries again next time. The main loop waits out a read in progress, which
+// only happens on a host : on the Daisy the audio interrupt always runs to
+// completion before the main loop resumes.
+class SharedAccess {
+public:
+    // Main loop
+    void beginWrite() {
+        uint8_t expected = Free;
+        while (!state.compare_exchange_weak(expected, Writing, std::memory_order_acquire, std::memory_order_relaxed)) {
+            expected = Free;
+        }
+    }
+
+    void endWrite() {
+        state.store(Free, std::memory_order_release);
+    }
+
+    // Audio block, false while the main loop is writing
+    bool tryRead() {
+        uint8_t expected = Free;
+        return state.compare_exchange_strong(expected, Reading, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void endRead() {
+        state.store(Free, std::memory_order_release);
+    }
+
+private:
+    enum : uint8_t {
+        Free = 0,
+        Writing,
+        Reading
+    };
+
+    std::atomic<uint8_t> state {Free};
+};
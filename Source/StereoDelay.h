@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    StereoDelay.h
+    Created: 19 Oct 2026 4:24:27am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "DelayLine.h"
+#include "BlockSize.h"
+
+#define DELAY_MAX_SECONDS 1.3f
+#define DELAY_DEFAULT_TIME 0.375f // Seconds
+#define DELAY_DEFAULT_FEEDBACK 0.35f
+
+// Two feedback delays, the right one slightly longer for width. The time
+// glides (no zipper, tape style pitch bend) and the repeats get darker.
+class StereoDelay {
+public:
+    enum Sync {
+        Sync_Off = 0,   // Free time
+        Sync_16th,
+        Sync_8th,
+        Sync_Dotted8th,
+        Sync_Quarter,
+        Sync_DottedQuarter,
+        Sync_Half,
+
+        Sync_Count
+    };
+
+public:
+    void init(float sampleRate, float* memory, size_t lineLength) {
+        this->sampleRate = sampleRate;
+        lines[0].init(memory, lineLength);
+        lines[1].init(memory + lineLength, lineLength);
+        maxDelay = (float)(lineLength - 2);
+        damping = 1.f - expf(-2.f * (float)M_PI * 4000.f / sampleRate);
+        glide = 1.f - expf(-1.f / (0.05f * sampleRate));
+        updateTime();
+        delay = targetDelay;
+    }
+
+    // 0 turns the delay off, the next process calls then cost nothing
+    void setMix(float mix) {
+        if (mix > 0.f && targetMix == 0.f && currentMix == 0.f) {
+            lines[0].reset();
+            lines[1].reset();
+        }
+        targetMix = mix;
+    }
+
+    void setTime(float seconds) {
+        freeTime = seconds;
+        updateTime();
+    }
+
+    void setSync(Sync sync) {
+        this->sync = sync;
+        updateTime();
+    }
+
+    void setTempo(float bpm) {
+        tempo = bpm;
+        updateTime();
+    }
+
+    void setFeedback(float feedback) {
+        this->feedback = feedback;
+    }
+
+    inline bool isActive() const noexcept {
+        return targetMix > 0.f || currentMix > 0.f;
+    }
+
+    void process(float* left, float* right, size_t frameCount) {
+        if (!isActive()) {
+            return;
+        }
+        const float mixFrom = currentMix;
+        currentMix = targetMix;
+        const float mixStep = (currentMix - mixFrom) / frameCount;
+
+        // The time moves once per block, linearly inside it
+        const float delayFrom = delay;
+        delay += (targetDelay - delay) * (1.f - powf(1.f - glide, (float)frameCount));
+        const float delayStep = (delay - delayFrom) / frameCount;
+
+        float* channels[2] = { left, right };
+        for (int channel = 0; channel < 2; channel++) {
+            float* buf = channels[channel];
+            const float spread = channel == 0 ? 1.f : rightRatio;
+            const float minDelay = frameCount + 1.f;
+            float lp = lowpass[channel];
+            for (size_t i = 0; i < frameCount; i++) {
+                const float d = fminf(fmaxf((delayFrom + delayStep * (i + 1)) * spread, minDelay), maxDelay);
+                lp += damping * (lines[channel].read(i, d) - lp);
+                wet[i] = lp;
+                feed[i] = buf[i] + lp * feedback;
+            }
+            lowpass[channel] = lp;
+            lines[channel].write(feed, frameCount);
+
+            for (size_t i = 0; i < frameCount; i++) {
+                buf[i] += wet[i] * (mixFrom + mixStep * (i + 1));
+            }
+        }
+    }
+
+private:
+    void updateTime() {
+        static const float beats[Sync_Count] = { 0.f, 0.25f, 0.5f, 0.75f, 1.f, 1.5f, 2.f };
+        const float seconds = sync == Sync_Off ? freeTime : beats[sync] * 60.f / tempo;
+        targetDelay = fminf(seconds * sampleRate, maxDelay / rightRatio);
+    }
+
+private:
+    static constexpr float rightRatio = 1.015f;
+
+    DelayLine lines[2];
+    float wet[MAX_BLOCK_SIZE];
+    float feed[MAX_BLOCK_SIZE];
+    float lowpass[2] = { 0.f, 0.f };
+
+    float sampleRate = 48000.f;
+    float maxDelay = 0.f;
+    float damping = 1.f;
+    float glide = 1.f;
+
+    Sync sync = Sync_Off;
+    float freeTime = DELAY_DEFAULT_TIME;
+    float tempo = 120.f;
+    float targetDelay = 0.f;
+    float delay = 0.f;
+    float feedback = DELAY_DEFAULT_FEEDBACK;
+    float targetMix = 0.f;
+    float currentMix = 0.f;
+};
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    SvfFilter.h
+    Created: 19 Oct 2026 4:09:36am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "daisysp.h"
+
+using namespace daisysp;
+
+// Prewarped SVF gain g = tan(pi * f / sr) for every MIDI note, so moving the
+// cutoff costs one interpolated lookup instead of mtof + tan. Shared by voices.
+class SvfCutoffTable {
+public:
+    void init(float sampleRate) {
+        const float maxFreq = sampleRate * 0.49f;
+        for (int note = 0; note < size; note++) {
+            float freq = fminf(mtof((float)note), maxFreq);
+            table[note] = tanf((float)M_PI * freq / sampleRate);
+        }
+    }
+
+    inline float lookup(float midiNote) const noexcept {
+        const float position = fclamp(midiNote, 0.f, (float)(size - 2));
+        const int index = (int)position;
+        const float fraction = position - index;
+        return table[index] + (table[index + 1] - table[index]) * fraction;
+    }
+
+private:
+    static constexpr int size = 136;
+    float table[size];
+};
+
+// Topology preserving transform state variable filter (zero delay feedback).
+// Stable whatever the cutoff does from one sample to the next.
+class SvfFilter {
+public:
+    enum Mode {
+        LowPass = 0,
+        BandPass,
+        HighPass
+    };
+
+public:
+    void init(const SvfCutoffTable* table) {
+        this->table = table;
+        ic1 = ic2 = 0.f;
+    }
+
+    void setResonance(float q) {
+        k = 1.f / q;
+    }
+
+    inline void setCutoff(float midiNote) noexcept {
+        g = table->lookup(midiNote);
+    }
+
+    inline float process(float in, Mode mode) noexcept {
+        const float a1 = 1.f / (1.f + g * (g + k));
+        const float a2 = g * a1;
+        const float a3 = g * a2;
+
+        const float v3 = in - ic2;
+        const float v1 = a1 * ic1 + a2 * v3;
+        const float v2 = ic2 + a2 * ic1 + a3 * v3;
+        ic1 = 2.f * v1 - ic1;
+        ic2 = 2.f * v2 - ic2;
+
+        switch (mode) {
+            case BandPass:  return v1;
+            case HighPass:  return in - k * v1 - v2;
+            case LowPass:
+            default:        return v2;
+        }
+    }
+
+private:
+    const SvfCutoffTable* table = nullptr;
+    float g = 0.f;
+    float k = 2.f;
+    float ic1 = 0.f;
+    float ic2 = 0.f;
+};
@@ -23,15 +23,24 @@ void SynthOsc::init(double sampleRate) {
     oscs[0].SetWaveform(sawWavf);
 }
 
+// Exact frequencies, cancels any ramp in progress
 void SynthOsc::setPitch(float pitch) {
+    this->pitch = pitch;
+    rampFrames = 0;
     uint8_t k = count;
     while(k--) {
         float factor = k == 1 ? 0.2f : -0.2f;
-        float freq = fast_mtof(pitch + sawDetune*factor);
-        oscs[k].SetFreq(fminf(freq, halfSr));
+        freqs[k] = fast_mtof(pitch + sawDetune*factor);
+        oscs[k].SetFreq(fminf(freqs[k], halfSr));
     }
 }
 
+// Exponential glide : every frequency is multiplied by ratio on each of the next frames
+void SynthOsc::rampPitch(float ratio, int frameCount) {
+    rampRatio = ratio;
+    rampFrames = frameCount;
+}
+
 void SynthOsc::setWaveform(float value) {
     if (value < 0.3333f) {
         oscs[1].SetWaveform(sawWavf);
@@ -48,17 +57,47 @@ void SynthOsc::setWaveform(float value) {
     oscMix *= oscMix;
     float pw = 0.5f - fmaxf(v - 1.f, 0.f) * 0.47f;
     oscs[1].SetPw(pw);
+    
+    // Crossfade gains taken once from the helper, not per sample
+    const float crossfade = fmaxf(oscMix, sawMix);
+    gains[0] = ydaisy::sqrtDryWet(0.f, 1.f, crossfade);
+    gains[1] = ydaisy::sqrtDryWet(1.f, 0.f, crossfade);
+    if (gains[1] == 0.f) {
+        render = Render_Main;
+    } else if (gains[0] == 0.f) {
+        render = Render_Second;
+    } else {
+        render = Render_Both;
+    }
+    
+    setPitch(pitch); // The saw detune moved
 }
 
-void SynthOsc::reset() {
+void SynthOsc::reset(float phase) {
     uint8_t k = count;
     while(k--) {
-        oscs[k].Reset();
+        oscs[k].Reset(phase);
     }
 }
 
 float SynthOsc::process() {
-    return ydaisy::sqrtDryWet(oscs[1].Process(), oscs[0].Process(), fmaxf(oscMix, sawMix));
+    if (rampFrames) {
+        rampFrames--;
+        uint8_t k = count;
+        while(k--) {
+            freqs[k] *= rampRatio;
+            oscs[k].SetFreq(fminf(freqs[k], halfSr));
+        }
+    }
+    switch (render) {
+        case Render_Main:
+            return oscs[0].Process() * gains[0];
+        case Render_Second:
+            return oscs[1].Process() * gains[1];
+        case Render_Both:
+        default:
+            return oscs[1].Process() * gains[1] + oscs[0].Process() * gains[0];
+    }
 }
 
 
@@ -22,11 +22,19 @@ public:
     void init(double sampleRate);
     void setWaveform(float value);
     void setPitch(float pitch);
+    void rampPitch(float ratio, int frameCount);
     
     float process();
-    void reset();
+    void reset(float phase = 0.f);
     
 private:
+    // Picked by setWaveform : an oscillator the crossfade silences isn't run
+    enum Render {
+        Render_Main = 0,    // oscs[0] alone, saw positions
+        Render_Second,      // oscs[1] alone, square and PWM positions
+        Render_Both         // Supersaw and the saw to square fade
+    };
+    
     static const uint8_t count = 2;
     Oscillator oscs[count];
     
@@ -37,4 +45,12 @@ private:
     float sawDetune = 0.f;
     float sawMix = 0.f;
     float halfSr = 0.f;
+    
+    Render render = Render_Main;
+    float gains[count] = { 1.f, 0.f };
+    
+    float pitch = 60.f;
+    float freqs[count];
+    float rampRatio = 1.f;
+    int rampFrames = 0;
 };
@@ -13,20 +13,23 @@
 
 const float SynthVoice::btune[] = {-24, -17, -12, -5, 0, 0.08, 0.2, 7, 12, 19, 24};
 
-void SynthVoice::init(double sampleRate) {
+void SynthVoice::init(double sampleRate, const SvfCutoffTable* cutoffTable, const EnvelopeShape* envelopeShape) {
 
     this->sampleRate = sampleRate;
     
     pitch.setImmediate(60);
 
-    adsr.Init(sampleRate);
+    envelope.init(envelopeShape);
     uint8_t k = oscCount;
     while(k--) {
         oscs[k].init(sampleRate);
     }
     filter.Init(sampleRate);
+    svf.init(cutoffTable);
+    svf.setResonance(filterRes);
     
     filterFreqSmoother.Init(20, sampleRate);
+    updateSources();
 }
 
 void SynthVoice::setPitch(int pitch) {
@@ -38,44 +41,47 @@ void SynthVoice::setGate(bool gate) {
 }
 
 void SynthVoice::setNoteOn(Note note) {
-    if (adsr.IsRunning() == false) { //In order to avoid clicks we should verify any output operators
+    if (envelope.isActive() == false) { //In order to avoid clicks we should verify any output operators
         uint8_t k = oscCount;
         while(k--) {
-            oscs[k].reset();
+            oscs[k].reset(startPhase);
         }
     }
     
     setPitch(note.pitch);
-    adsr.Retrigger(false);
+    pitchDirty = true;
+    controlCounter = 0;
+    envelope.gateOn(note.velocity);
     setGate(true);
     noteTimeStamp = note.timeStamp;
 }
 
+// Oscillator phase used by the next note that starts from silence
+void SynthVoice::setStartPhase(float phase) {
+    this->startPhase = phase;
+}
+
 void SynthVoice::setNoteOff() {
     setGate(false);
+    envelope.gateOff();
 }
 
 void SynthVoice::setGlide(float glide) {
     this->glideFrameLength = (glide*glide)*sampleRate;
 }
 
-void SynthVoice::setADSR(float attack, float decay, float sustain, float release) {
-   adsr.SetAttackTime(attack);
-   adsr.SetDecayTime(decay);
-   adsr.SetSustainLevel(sustain);
-   adsr.SetReleaseTime(release);
-}
-
 void SynthVoice::setWaveform(uint8_t oscIndex, float value) {
     oscs[oscIndex].setWaveform(value);
 }
 
 void SynthVoice::setOctave(int8_t octave) {
     this->octave = octave;
+    pitchDirty = true;
 }
 
 void SynthVoice::setOscBTune(uint8_t tuneIndex) {
     this->tune = btune[tuneIndex];
+    pitchDirty = true;
 }
 
 void SynthVoice::setOscBPW(float pw) {
@@ -84,10 +90,22 @@ void SynthVoice::setOscBPW(float pw) {
 
 void SynthVoice::setOscMix(float mix) {
     this->mix = 1.f - (mix * mix);
+    updateSources();
 }
 
 void SynthVoice::setNoiseMix(float mix) {
     this->noiseMix = mix;
+    updateSources();
+}
+
+// Both crossfades folded into per source gains, once per change. A source
+// with a zero gain isn't rendered at all.
+void SynthVoice::updateSources() {
+    const float toneGain = ydaisy::sqrtDryWet(0.f, 1.f, noiseMix);
+    noiseGain = ydaisy::sqrtDryWet(1.f, 0.f, noiseMix);
+    sourceGains[0] = ydaisy::sqrtDryWet(1.f, 0.f, mix) * toneGain;
+    sourceGains[1] = ydaisy::sqrtDryWet(0.f, 1.f, mix) * toneGain;
+    sources = static_cast<Sources>((sourceGains[0] != 0.f ? Sources_OscA : 0) | (sourceGains[1] != 0.f ? Sources_OscB : 0));
 }
 
 void SynthVoice::setFilterMidiFreq(float freq) {
@@ -96,13 +114,43 @@ void SynthVoice::setFilterMidiFreq(float freq) {
 
 void SynthVoice::setFilterRes(float res) {
     this->filterRes = res;
+    svf.setResonance(res);
 }
 
 void SynthVoice::setFilterEnv(float env) {
     this->filterEnv = env;
 }
 
-void SynthVoice::prepare() {
+void SynthVoice::setFilterType(FilterType type) {
+    this->filterType = type;
+}
+
+// Control rate : the oscillators glide exponentially towards target over the
+// next PITCH_CONTROL_FRAMES samples, nothing is computed when the pitch holds.
+// Modulation is therefore heard PITCH_CONTROL_FRAMES samples late.
+void SynthVoice::updatePitch(float target) {
+    if (!pitchDirty) {
+        if (target == controlPitch) {
+            return;
+        }
+        oscs[0].setPitch(controlPitch + octave*12.f);
+        oscs[1].setPitch(controlPitch + tune);
+        
+        const float ratio = exp2f((target - controlPitch) * (1.f / (12.f * PITCH_CONTROL_FRAMES)));
+        oscs[0].rampPitch(ratio, PITCH_CONTROL_FRAMES);
+        oscs[1].rampPitch(ratio, PITCH_CONTROL_FRAMES);
+    } else { // New note or new tuning : no glide from the previous pitch
+        oscs[0].setPitch(target + octave*12.f);
+        oscs[1].setPitch(target + tune);
+        pitchDirty = false;
+    }
+    controlPitch = target;
+}
+
+// Block start, before any process call
+void SynthVoice::renderEnvelope(size_t frameCount) {
+    envelope.process(envBuffer, frameCount);
+    envIndex = 0;
 }
 
 float SynthVoice::process(float whiteNoiseIn, float filterMod) {
@@ -110,19 +158,46 @@ float SynthVoice::process(float whiteNoiseIn, float filterMod) {
     pitch.dezipperCheck(glideFrameLength);
     
     float mainPitch = pitch.getAndStep() + pitchMod;
+    if (controlCounter == 0 || pitchDirty) { // A new note or tuning doesn't wait for the next update
+        updatePitch(mainPitch);
+        controlCounter = PITCH_CONTROL_FRAMES;
+    }
+    controlCounter--;
     
-    float envOut = adsr.Process(gate);
-    
-    oscs[0].setPitch(mainPitch + octave*12.f);
-    oscs[1].setPitch(mainPitch + tune);
-
-    float oscMix = ydaisy::sqrtDryWet(oscs[0].process(), oscs[1].process(), mix);
-    float outMix = ydaisy::sqrtDryWet(whiteNoiseIn, oscMix, noiseMix);
+    float envOut = envBuffer[envIndex++];
+
+    float outMix;
+    switch (sources) {
+        case Sources_OscA:
+            outMix = oscs[0].process() * sourceGains[0];
+            break;
+        case Sources_OscB:
+            outMix = oscs[1].process() * sourceGains[1];
+            break;
+        case Sources_Both:
+            outMix = oscs[0].process() * sourceGains[0] + oscs[1].process() * sourceGains[1];
+            break;
+        case Sources_None:
+        default:
+            outMix = 0.f;
+            break;
+    }
+    if (noiseGain != 0.f) {
+        outMix += whiteNoiseIn * noiseGain;
+    }
     
     float smoothMod = filterFreqSmoother.Process(filterMod);
     
-    float fFreq = fast_mtof(fminf(filterMidiFreq + envOut*90.f*filterEnv + smoothMod, 132.f));
-    filter.SetLowpass(fFreq, filterRes);
+    float cutoff = fminf(filterMidiFreq + envOut*90.f*filterEnv + smoothMod, 132.f);
+    float filtered;
+    if (filterType == FilterType_Biquad) {
+        filter.SetLowpass(fast_mtof(cutoff), filterRes);
+        filtered = filter.Process(outMix);
+    } else {
+        // One table lookup per sample, no coefficient recomputation
+        svf.setCutoff(cutoff);
+        filtered = svf.process(outMix, static_cast<SvfFilter::Mode>(filterType - FilterType_SvfLowPass));
+    }
 
-    return filter.Process(outMix) * envOut * envOut;
+    return filtered * envOut * envOut;
 }
@@ -13,6 +13,9 @@
 #include "DaisyYMNK/DSP/DSP.h"
 #include "DaisyYMNK/Common/Common.h"
 #include "SynthOsc.h"
+#include "SvfFilter.h"
+#include "Envelope.h"
+#include "BlockSize.h"
 #include "daisysp.h"
 
 using namespace ydaisy;
@@ -21,6 +24,8 @@ using namespace std;
 using namespace daisysp;
 //using namespace ydaisy;
 
+#define PITCH_CONTROL_FRAMES 8 // Samples between two pitch updates, 0.17 ms of modulation lag at 48 kHz
+
 class OnePoleSmoother {
 public:
     void Init(float timeMs, float sr) {
@@ -38,14 +43,20 @@ private:
 
 class SynthVoice {
 public:
-    void init(double sampleRate);
+    enum FilterType {
+        FilterType_Biquad = 0,
+        FilterType_SvfLowPass,
+        FilterType_SvfBandPass,
+        FilterType_SvfHighPass,
+        
+        FilterType_Count
+    };
     
-    void prepare();
+public:
+    void init(double sampleRate, const SvfCutoffTable* cutoffTable, const EnvelopeShape* envelopeShape);
     
     void setGlide(float glide);
     
-    void setADSR(float attack, float decay, float sustain, float release);
-    
     void setWaveform(uint8_t oscIndex, float value);
     void setOctave(int8_t octave);
     void setOscBTune(uint8_t tuneIndex);
@@ -55,10 +66,13 @@ public:
     void setFilterMidiFreq(float freq);
     void setFilterRes(float res);
     void setFilterEnv(float env);
+    void setFilterType(FilterType type);
     
+    void setStartPhase(float phase);
     void setNoteOn(Note note);
     void setNoteOff();
     
+    void renderEnvelope(size_t frameCount);
     float process(float whiteNoiseIn, float filterMod);
     
     //TO REWRITE
@@ -67,12 +81,22 @@ public:
     }
     
     inline bool isPlaying() noexcept {
-        return gate || adsr.IsRunning();
+        return gate || envelope.isActive();
+    }
+    
+    inline bool isGateOn() noexcept {
+        return gate;
+    }
+    
+    inline float getLevel() noexcept {
+        return envelope.getLevel();
     }
     
 private:
     void setPitch(int pitch);
+    void updatePitch(float target);
     void setGate(bool gate);
+    void updateSources();
     
 public:
     static const uint8_t btuneCount = 11;
@@ -93,23 +117,42 @@ private:
     long glideFrameLength = 0;
     
     float tune = 0;
+    float startPhase = 0;
     float pw = 0.5;
     float mix = 0.5;
     
     float filterMidiFreq = 800;
     float filterRes = 0.5;
     float filterEnv = 0.25;
+    FilterType filterType = FilterType_Biquad;
 
     SmoothValue pitch;
+    float controlPitch = 0;
+    int controlCounter = 0;
+    bool pitchDirty = true;
     bool gate = false;
     
     static const uint8_t oscCount = 2;
     
+    // What the oscillator and noise mixes leave audible, see updateSources
+    enum Sources {
+        Sources_None = 0,   // Noise only
+        Sources_OscA,
+        Sources_OscB,
+        Sources_Both
+    };
+    
     float noiseMix = 0;
+    Sources sources = Sources_Both;
+    float sourceGains[oscCount] = { 0.f, 0.f };
+    float noiseGain = 0.f;
     OnePoleSmoother filterFreqSmoother;
     
-    Adsr adsr;
+    Envelope envelope;
+    float envBuffer[MAX_BLOCK_SIZE];
+    size_t envIndex = 0;
     SynthOsc oscs[oscCount];
     BiquadFilter filter;
+    SvfFilter svf;
  
 };
@@ -0,0 +1,157 @@
+/*
+  ==============================================================================
+
+    VoiceWorkers.h
+    Created: 19 Oct 2026 4:02:43am
+    Author:  Alexis ZBIK
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define MAX_VOICE_THREADS 8
+
+// Fixed pool of threads for host builds. The audio thread is partition 0,
+// workers take partitions 1..n. Synchronisation is two atomics : a block
+// generation the workers wait on, and a countdown the audio thread waits on.
+// Both sides spin for a short window only, then park on a futex : idle
+// workers cost nothing between blocks or while the synth renders on the audio
+// thread alone, and waking them is one syscall that never takes a lock.
+template <typename Owner>
+class VoiceWorkers {
+public:
+    typedef void (Owner::*Job)(int partition);
+
+public:
+    ~VoiceWorkers() {
+        stop();
+    }
+
+    void start(Owner* owner, Job job, int threadCount) {
+        stop();
+        this->owner = owner;
+        this->job = job;
+        workerCount = std::max(0, std::min(threadCount, MAX_VOICE_THREADS) - 1);
+        running.store(true);
+        const unsigned int startGeneration = generation.load();
+        for (int k = 0; k < workerCount; k++) {
+            threads[k] = std::thread(&VoiceWorkers::workerLoop, this, k + 1, startGeneration);
+        }
+    }
+
+    void stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        generation.fetch_add(1);
+        wake(generation, INT_MAX);
+        for (int k = 0; k < workerCount; k++) {
+            threads[k].join();
+        }
+        workerCount = 0;
+    }
+
+    // Called from the audio thread, returns once every partition is rendered
+    void run() {
+        remaining.store(workerCount, std::memory_order_relaxed);
+        generation.fetch_add(1);
+        if (parkedWorkers.load() > 0) {
+            wake(generation, INT_MAX);
+        }
+
+        (owner->*job)(0);
+
+        for (int spins = 0; remaining.load(std::memory_order_acquire) != 0; spins++) {
+            if (spins < spinsBeforePark) {
+                continue;
+            }
+            ownerParked.store(true);
+            int left;
+            while ((left = remaining.load()) != 0) {
+                park(remaining, left);
+            }
+            ownerParked.store(false);
+        }
+    }
+
+    inline int getThreadCount() noexcept {
+        return workerCount + 1;
+    }
+
+private:
+    void workerLoop(int partition, unsigned int seen) {
+        for (;;) {
+            unsigned int current;
+            int spins = 0;
+            while ((current = generation.load(std::memory_order_acquire)) == seen) {
+                if (++spins > spinsBeforePark) {
+                    parkedWorkers.fetch_add(1);
+                    park(generation, seen);
+                    parkedWorkers.fetch_sub(1);
+                    spins = 0;
+                }
+            }
+            seen = current;
+            if (!running.load(std::memory_order_acquire)) {
+                return;
+            }
+            (owner->*job)(partition);
+            if (remaining.fetch_sub(1) == 1 && ownerParked.load()) {
+                wake(remaining, 1);
+            }
+        }
+    }
+
+    // Sleeps while word still holds expected. The waker changes the word
+    // before reading the parked flag, the sleeper sets the flag before reading
+    // the word (both seq_cst), so a wake-up can't be missed.
+    template <typename T>
+    static void park(std::atomic<T>& word, T expected) {
+        static_assert(sizeof(std::atomic<T>) == sizeof(int), "futex word");
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE, (int)expected, nullptr, nullptr, 0);
+#else
+        (void)word;
+        (void)expected;
+        std::this_thread::yield();
+#endif
+    }
+
+    template <typename T>
+    static void wake(std::atomic<T>& word, int count) {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+        (void)word;
+        (void)count;
+#endif
+    }
+
+private:
+    // About 10-20 us of spinning on a desktop core, less than a block
+    static constexpr int spinsBeforePark = 2000;
+
+    Owner* owner = nullptr;
+    Job job = nullptr;
+
+    std::thread threads[MAX_VOICE_THREADS];
+    int workerCount = 0;
+
+    std::atomic<bool> running {false};
+    std::atomic<unsigned int> generation {0};
+    std::atomic<int> remaining {0};
+    std::atomic<int> parkedWorkers {0};
+    std::atomic<bool> ownerParked {false};
+};
@@ -0,0 +1,373 @@
+/*
+  ==============================================================================
+
+    BatchRender.cpp
+    Created: 19 Oct 2026 3:59:47am
+    Author:  Alexis ZBIK
+
+    Renders every preset of a catalog against a fixed set of notes and chords,
+    one independent PolyAnalogDSP per render, spread over a work-stealing pool.
+
+    Usage : BatchRender [--presets file] [--out dir] [--threads n] [--scaling] [--stress] [--trace]
+
+    --stress adds random notes, CCs, pitch bend and play mode changes on every
+    block. --trace writes each render's event trace next to its WAV file, for
+    Tools/TraceDecode. BatchRenderRT is the same tool built with REALTIME_CHECK, it aborts
+    on any allocation or lock inside the audio callback.
+
+    The catalog is a text file with one preset per line, values in parameter
+    order (the same layout as the QSPI presets).
+
+  ==============================================================================
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PolyAnalogDSP.h"
+
+struct TestChord {
+    const char* name;
+    int notes[4];
+    int count;
+};
+
+static const TestChord testChords[] = {
+    {"C2",      {36},               1},
+    {"C4",      {60},               1},
+    {"C6",      {84},               1},
+    {"Cmaj",    {60, 64, 67},       3},
+    {"Am7",     {57, 60, 64, 67},   4},
+    {"Fmaj7",   {41, 45, 48, 52},   4},
+};
+static constexpr int testChordCount = sizeof(testChords) / sizeof(TestChord);
+
+struct RenderSettings {
+    double sampleRate = 48000;
+    int blockSize = 48;
+    float noteSeconds = 2.f;
+    float tailSeconds = 1.f;
+    bool stress = false;
+    bool trace = false;
+    std::string outDir;
+};
+
+struct RenderJob {
+    int presetIndex;
+    int chordIndex;
+};
+
+//==============================================================================
+// Streams float frames to disk, the header is patched once the size is known
+class WavWriter {
+public:
+    bool open(const std::string& path, int channelCount, int sampleRate) {
+        file = fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        this->channelCount = channelCount;
+        this->sampleRate = sampleRate;
+        writeHeader(0);
+        return true;
+    }
+
+    void write(float** buf, int frameCount) {
+        interleaved.resize(frameCount * channelCount);
+        for (int i = 0; i < frameCount; i++) {
+            for (int channel = 0; channel < channelCount; channel++) {
+                interleaved[i * channelCount + channel] = buf[channel][i];
+            }
+        }
+        fwrite(interleaved.data(), sizeof(float), interleaved.size(), file);
+        dataSize += interleaved.size() * sizeof(float);
+    }
+
+    void close() {
+        if (!file) {
+            return;
+        }
+        fseek(file, 0, SEEK_SET);
+        writeHeader(dataSize);
+        fclose(file);
+        file = nullptr;
+    }
+
+private:
+    void writeHeader(uint32_t size) {
+        const uint16_t format = 3; // IEEE float
+        const uint16_t channels = channelCount;
+        const uint32_t rate = sampleRate;
+        const uint16_t blockAlign = channelCount * sizeof(float);
+        const uint32_t byteRate = rate * blockAlign;
+        const uint16_t bits = 32;
+        const uint32_t fmtSize = 16;
+        const uint32_t riffSize = 36 + size;
+
+        fwrite("RIFF", 1, 4, file);
+        fwrite(&riffSize, 4, 1, file);
+        fwrite("WAVEfmt ", 1, 8, file);
+        fwrite(&fmtSize, 4, 1, file);
+        fwrite(&format, 2, 1, file);
+        fwrite(&channels, 2, 1, file);
+        fwrite(&rate, 4, 1, file);
+        fwrite(&byteRate, 4, 1, file);
+        fwrite(&blockAlign, 2, 1, file);
+        fwrite(&bits, 2, 1, file);
+        fwrite("data", 1, 4, file);
+        fwrite(&size, 4, 1, file);
+    }
+
+private:
+    FILE* file = nullptr;
+    std::vector<float> interleaved;
+    int channelCount = 2;
+    int sampleRate = 48000;
+    uint32_t dataSize = 0;
+};
+
+//==============================================================================
+// Each worker owns a deque : it pops its own jobs from the back and steals
+// from the front of the others once it runs dry.
+class WorkStealingPool {
+public:
+    WorkStealingPool(int workerCount) : queues(workerCount) {}
+
+    void push(int worker, const RenderJob& job) {
+        queues[worker].jobs.push_back(job);
+    }
+
+    bool pop(int worker, RenderJob& job) {
+        {
+            WorkerQueue& own = queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = own.jobs.back();
+                own.jobs.pop_back();
+                return true;
+            }
+        }
+        const int workerCount = (int)queues.size();
+        for (int k = 1; k < workerCount; k++) {
+            WorkerQueue& victim = queues[(worker + k) % workerCount];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = victim.jobs.front();
+                victim.jobs.pop_front();
+                steals++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+public:
+    std::atomic<int> steals {0};
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<RenderJob> jobs;
+    };
+    std::vector<WorkerQueue> queues;
+};
+
+//==============================================================================
+static uint32_t hostClock() {
+    using namespace std::chrono;
+    return (uint32_t)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+static void writeTrace(PolyAnalogDSP& dsp, const char* path) {
+    std::vector<TraceEvent> events(TRACE_EVENT_COUNT);
+    size_t count = dsp.getTrace().snapshot(events.data(), events.size());
+    if (FILE* file = fopen(path, "wb")) {
+        fwrite(events.data(), sizeof(TraceEvent), count, file);
+        fclose(file);
+    }
+}
+
+//==============================================================================
+// MIDI storm on top of the test chord
+static void sendStressEvents(PolyAnalogDSP& dsp, std::minstd_rand& random) {
+    const int eventCount = random() % 8;
+    for (int k = 0; k < eventCount; k++) {
+        const int note = 24 + random() % 72;
+        switch (random() % 5) {
+            case 0: dsp.processMIDI(kNoteOn, 0, note, 1 + random() % 127); break;
+            case 1: dsp.processMIDI(kNoteOff, 0, note, 0); break;
+            case 2: dsp.processMIDI(kControlChange, 0, parameterSchema[random() % PolyAnalogDSP::Count].cc, random() % 128); break;
+            case 3: dsp.processMIDI(kPitchBend, 0, random() % 16384, 0); break;
+            case 4: dsp.processMIDI(kControlChange, 0, 1, random() % 128); break;
+        }
+    }
+}
+
+static void render(const RenderJob& job, const std::vector<float>& preset, const RenderSettings& settings) {
+    PolyAnalogDSP dsp;
+    dsp.init(2, settings.sampleRate);
+    dsp.getTrace().setClock(hostClock);
+    if (!preset.empty()) {
+        dsp.loadPreset(preset.data());
+    }
+
+    std::vector<float> left(settings.blockSize), right(settings.blockSize);
+    float* buf[2] = { left.data(), right.data() };
+
+    WavWriter writer;
+    bool writing = false;
+    char name[256];
+    snprintf(name, sizeof(name), "%s/preset%03d_%s",
+             settings.outDir.c_str(), job.presetIndex, testChords[job.chordIndex].name);
+    if (!settings.outDir.empty()) {
+        writing = writer.open(std::string(name) + ".wav", 2, (int)settings.sampleRate);
+    }
+
+    const TestChord& chord = testChords[job.chordIndex];
+    for (int k = 0; k < chord.count; k++) {
+        dsp.processMIDI(kNoteOn, 0, chord.notes[k], 100);
+    }
+
+    std::minstd_rand random(job.presetIndex * testChordCount + job.chordIndex + 1);
+    
+    const long noteFrames = (long)(settings.noteSeconds * settings.sampleRate);
+    const long totalFrames = noteFrames + (long)(settings.tailSeconds * settings.sampleRate);
+    bool released = false;
+
+    for (long frame = 0; frame < totalFrames; frame += settings.blockSize) {
+        if (!released && frame >= noteFrames) {
+            for (int k = 0; k < chord.count; k++) {
+                dsp.processMIDI(kNoteOff, 0, chord.notes[k], 0);
+            }
+            released = true;
+        }
+        if (settings.stress) {
+            sendStressEvents(dsp, random);
+        }
+        dsp.process(buf, settings.blockSize);
+        if (writing) {
+            writer.write(buf, settings.blockSize);
+        }
+    }
+    writer.close();
+    
+    if (settings.trace && !settings.outDir.empty()) {
+        writeTrace(dsp, (std::string(name) + ".trace").c_str());
+    }
+}
+
+static double runBatch(const std::vector<std::vector<float>>& presets, const RenderSettings& settings, int threadCount) {
+    WorkStealingPool pool(threadCount);
+
+    const int presetCount = (int)presets.size();
+    int jobIndex = 0;
+    for (int preset = 0; preset < presetCount; preset++) {
+        for (int chord = 0; chord < testChordCount; chord++) {
+            pool.push(jobIndex++ % threadCount, {preset, chord});
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < threadCount; worker++) {
+        workers.emplace_back([&, worker]() {
+            RenderJob job;
+            while (pool.pop(worker, job)) {
+                render(job, presets[job.presetIndex], settings);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double rendersPerSecond = jobIndex / elapsed.count();
+
+    printf("%2d threads : %d renders in %.2f s, %.1f renders/s, %d steals\n",
+           threadCount, jobIndex, elapsed.count(), rendersPerSecond, pool.steals.load());
+    return rendersPerSecond;
+}
+
+static std::vector<std::vector<float>> loadCatalog(const char* path) {
+    std::vector<std::vector<float>> presets;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream values(line);
+        std::vector<float> preset;
+        float value;
+        while (values >> value) {
+            preset.push_back(value);
+        }
+        if (preset.empty()) {
+            continue;
+        }
+        const int size = std::min((int)preset.size(), (int)PolyAnalogDSP::Count);
+        preset.resize(PolyAnalogDSP::Count);
+        fillParameterDefaults(preset.data(), size); // Older catalogs lack the appended parameters
+        presets.push_back(preset);
+    }
+    return presets;
+}
+
+int main(int argc, char* argv[]) {
+    RenderSettings settings;
+    const char* catalogPath = nullptr;
+    int threadCount = (int)std::thread::hardware_concurrency();
+    bool scaling = false;
+
+    for (int k = 1; k < argc; k++) {
+        if (!strcmp(argv[k], "--presets") && k + 1 < argc) {
+            catalogPath = argv[++k];
+        } else if (!strcmp(argv[k], "--out") && k + 1 < argc) {
+            settings.outDir = argv[++k];
+        } else if (!strcmp(argv[k], "--threads") && k + 1 < argc) {
+            threadCount = atoi(argv[++k]);
+        } else if (!strcmp(argv[k], "--scaling")) {
+            scaling = true;
+        } else if (!strcmp(argv[k], "--stress")) {
+            settings.stress = true;
+        } else if (!strcmp(argv[k], "--trace")) {
+            settings.trace = true;
+        }
+    }
+    if (threadCount < 1) {
+        threadCount = 1;
+    }
+
+    std::vector<std::vector<float>> presets;
+    if (catalogPath) {
+        presets = loadCatalog(catalogPath);
+    }
+    if (presets.empty()) {
+        presets.push_back({}); // Default parameters only
+    }
+    printf("%zu presets x %d chords\n", presets.size(), testChordCount);
+
+    if (!scaling) {
+        runBatch(presets, settings, threadCount);
+        return 0;
+    }
+
+    double single = 0;
+    for (int threads = 1; threads <= threadCount; threads *= 2) {
+        double rate = runBatch(presets, settings, threads);
+        if (threads == 1) {
+            single = rate;
+        }
+        printf("           speedup x%.2f\n", rate / single);
+    }
+    return 0;
+}
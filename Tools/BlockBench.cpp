@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    BlockBench.cpp
+    Created: 19 Oct 2026 4:07:36am
+    Author:  Alexis ZBIK
+
+    Renders the same chord with audio block sizes from 1 to 256 frames and
+    reports the cost per frame, and how much of it is per-block overhead
+    compared to the largest block.
+
+    Usage : BlockBench [seconds]
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "PolyAnalogDSP.h"
+
+static constexpr double sampleRate = 48000;
+static const int blockSizes[] = { 1, 2, 4, 8, 16, 32, 48, 64, 128, 256 };
+
+static double renderNsPerFrame(int blockSize, double seconds) {
+    PolyAnalogDSP dsp;
+    dsp.init(2, sampleRate);
+    dsp.setParameterValue(PolyAnalogDSP::PlayMode, 1.f); // Poly
+    const int chord[] = { 48, 55, 60, 64 };
+    for (int note : chord) {
+        dsp.processMIDI(kNoteOn, 0, note, 100);
+    }
+
+    std::vector<float> left(blockSize), right(blockSize);
+    float* buf[2] = { left.data(), right.data() };
+    const long blockCount = (long)(seconds * sampleRate / blockSize);
+
+    auto start = std::chrono::steady_clock::now();
+    for (long block = 0; block < blockCount; block++) {
+        dsp.process(buf, blockSize);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (blockCount * blockSize);
+}
+
+int main(int argc, char* argv[]) {
+    const double seconds = argc > 1 ? atof(argv[1]) : 10.0;
+
+    const int sizeCount = sizeof(blockSizes) / sizeof(int);
+    std::vector<double> costs(sizeCount);
+    for (int k = 0; k < sizeCount; k++) {
+        costs[k] = renderNsPerFrame(blockSizes[k], seconds);
+    }
+
+    const double reference = costs[sizeCount - 1];
+    printf("block   latency ms   ns/frame   per-block overhead\n");
+    for (int k = 0; k < sizeCount; k++) {
+        const double overhead = (costs[k] - reference) * blockSizes[k];
+        printf("%5d   %10.2f   %8.1f   %+6.1f%% (%.0f ns/block)\n", blockSizes[k], blockSizes[k] * 1000.0 / sampleRate,
+               costs[k], (costs[k] / reference - 1.0) * 100.0, overhead);
+    }
+    return 0;
+}
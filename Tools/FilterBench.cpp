@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    FilterBench.cpp
+    Created: 19 Oct 2026 4:09:36am
+    Author:  Alexis ZBIK
+
+    Times the voice filters with the cutoff moving on every sample (envelope
+    plus audio-rate LFO), the biquad against the three SVF outputs, then
+    checks that each one stays bounded under a fast resonant sweep.
+
+    Usage : FilterBench
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "SynthVoice.h"
+
+static constexpr float sampleRate = 48000;
+static constexpr int frameCount = 48000 * 10;
+static constexpr float resonance = 4.f;
+
+// Cutoff in MIDI notes, swept by a 2 kHz LFO over 4 octaves
+static inline float cutoffAt(int frame) {
+    return 72.f + 24.f * sinf(2.f * (float)M_PI * 2000.f * frame / sampleRate);
+}
+
+struct Result {
+    double nsPerSample;
+    float peak;
+};
+
+template <typename Process>
+static Result run(Process process) {
+    std::minstd_rand random(1);
+    std::uniform_real_distribution<float> noise(-1.f, 1.f);
+    float peak = 0.f;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frameCount; frame++) {
+        const float out = process(noise(random), cutoffAt(frame));
+        peak = std::isfinite(out) ? fmaxf(peak, fabsf(out)) : INFINITY;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return { elapsed.count() / frameCount, peak };
+}
+
+static void print(const char* name, const Result& result, double reference) {
+    const bool stable = std::isfinite(result.peak) && result.peak < 100.f;
+    printf("%-14s %8.2f ns   x%.2f   peak %8.2f   %s\n",
+           name, result.nsPerSample, reference / result.nsPerSample, result.peak, stable ? "stable" : "UNSTABLE");
+}
+
+int main() {
+    printf("%d samples, cutoff modulated every sample, Q %.1f\n\n", frameCount, resonance);
+
+    BiquadFilter biquad;
+    biquad.Init(sampleRate);
+    const Result biquadResult = run([&](float in, float cutoff) {
+        biquad.SetLowpass(fast_mtof(cutoff), resonance);
+        return biquad.Process(in);
+    });
+    print("biquad LP", biquadResult, biquadResult.nsPerSample);
+
+    SvfCutoffTable table;
+    table.init(sampleRate);
+
+    const char* names[] = { "svf LP", "svf BP", "svf HP" };
+    for (int mode = SvfFilter::LowPass; mode <= SvfFilter::HighPass; mode++) {
+        SvfFilter svf;
+        svf.init(&table);
+        svf.setResonance(resonance);
+        const Result result = run([&](float in, float cutoff) {
+            svf.setCutoff(cutoff);
+            return svf.process(in, static_cast<SvfFilter::Mode>(mode));
+        });
+        print(names[mode], result, biquadResult.nsPerSample);
+    }
+    return 0;
+}
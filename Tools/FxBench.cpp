@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    FxBench.cpp
+    Created: 19 Oct 2026 4:24:27am
+    Author:  Alexis ZBIK
+
+    Times the master bus with the effects off, the chorus, the delay (free
+    and tempo synced) and both, at the firmware block size. The cost of an
+    effect is its line minus the bypass line, which should match the bus
+    of old.
+
+    Usage : FxBench [blockSize]
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "MasterBus.h"
+
+static constexpr float sampleRate = 48000;
+static constexpr int frameCount = 48000 * 20;
+
+struct Setup {
+    const char* name;
+    float chorusMix;
+    float delayMix;
+    StereoDelay::Sync sync;
+};
+
+static double run(const Setup& setup, size_t blockSize, std::vector<float>& memory) {
+    MasterBus bus;
+    bus.init(sampleRate);
+    bus.initEffects(memory.data(), memory.size());
+    bus.getChorus().setMix(setup.chorusMix);
+    bus.getDelay().setMix(setup.delayMix);
+    bus.getDelay().setSync(setup.sync);
+    bus.getDelay().setTempo(128.f);
+    bus.getDelay().setFeedback(0.6f);
+
+    std::minstd_rand random(1);
+    std::uniform_real_distribution<float> noise(-1.f, 1.f);
+    std::vector<float> source(blockSize * 64);
+    for (float& sample : source) {
+        sample = noise(random);
+    }
+    std::vector<float> left(blockSize), right(blockSize);
+
+    float sink = 0.f;
+    const int blockCount = frameCount / blockSize;
+    auto start = std::chrono::steady_clock::now();
+    for (int block = 0; block < blockCount; block++) {
+        const float* in = &source[(block % 64) * blockSize];
+        for (size_t i = 0; i < blockSize; i++) {
+            left[i] = in[i];
+            right[i] = -in[i];
+        }
+        bus.process(left.data(), right.data(), blockSize, 0.8f, 1.f, 1.f);
+        sink += left[0] + right[blockSize - 1];
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    if (!std::isfinite(sink)) {
+        printf("%s : output is not finite\n", setup.name);
+    }
+    return elapsed.count() / (blockCount * blockSize);
+}
+
+int main(int argc, char** argv) {
+    const size_t blockSize = argc > 1 ? strtoul(argv[1], nullptr, 10) : 48;
+    if (blockSize < 1 || blockSize > MAX_BLOCK_SIZE) {
+        fprintf(stderr, "Block size must be 1..%d\n", MAX_BLOCK_SIZE);
+        return 1;
+    }
+    printf("%d frames, blocks of %zu\n\n", frameCount, blockSize);
+
+    std::vector<float> memory(EFFECTS_MEMORY_SIZE, 0.f);
+    const Setup setups[] = {
+        { "bypass",        0.f, 0.f, StereoDelay::Sync_Off },
+        { "chorus",        1.f, 0.f, StereoDelay::Sync_Off },
+        { "delay",         0.f, 1.f, StereoDelay::Sync_Off },
+        { "delay synced",  0.f, 1.f, StereoDelay::Sync_Dotted8th },
+        { "chorus+delay",  1.f, 1.f, StereoDelay::Sync_Off },
+    };
+
+    double bypass = 0.;
+    for (const Setup& setup : setups) {
+        const double ns = run(setup, blockSize, memory);
+        if (setup.chorusMix == 0.f && setup.delayMix == 0.f) {
+            bypass = ns;
+        }
+        printf("%-14s %8.2f ns/frame   effects %+8.2f ns/frame\n", setup.name, ns, ns - bypass);
+    }
+    return 0;
+}
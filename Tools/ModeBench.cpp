@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    ModeBench.cpp
+    Created: 19 Oct 2026 4:16:07am
+    Author:  Alexis ZBIK
+
+    Times PolySynth::process and note handling in each play mode, to keep an
+    eye on what each mode's render loop costs.
+
+    Usage : ModeBench
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cstdio>
+
+#include "PolySynth.h"
+
+static constexpr double sampleRate = 48000;
+static constexpr int blockSize = 48;
+static constexpr int blockCount = 20000;
+static constexpr int noteCount = 200000;
+
+struct ModeSetup {
+    const char* name;
+    PolySynth::EPolyMode mode;
+    int heldNotes;
+};
+
+static const ModeSetup modes[] = {
+    {"Mono",    PolySynth::Mono,    1},
+    {"Unison",  PolySynth::Unison,  1},
+    {"Poly",    PolySynth::Poly,    VOICE_COUNT},
+};
+
+static double timeRender(PolySynth& synth) {
+    float left[blockSize], right[blockSize];
+    float pitchLfo[blockSize] = {}, filterLfo[blockSize] = {};
+
+    auto start = std::chrono::steady_clock::now();
+    for (int block = 0; block < blockCount; block++) {
+        synth.process(left, right, pitchLfo, filterLfo, blockSize);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / ((double)blockCount * blockSize);
+}
+
+static double timeNotes(PolySynth& synth) {
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < noteCount; k++) {
+        const int pitch = 36 + (k * 7) % 48;
+        synth.setNote(true, Note(pitch, 100, k));
+        synth.setNote(false, Note(pitch, 0, k));
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (2.0 * noteCount);
+}
+
+int main() {
+    printf("Block %d\n\n", blockSize);
+    printf("mode      ns/sample   ns/note event\n");
+
+    for (const ModeSetup& setup : modes) {
+        PolySynth synth;
+        synth.init(sampleRate);
+        synth.setPolyMode(setup.mode);
+        for (int k = 0; k < setup.heldNotes; k++) {
+            synth.setNote(true, Note(48 + k * 4, 100, k));
+        }
+        const double render = timeRender(synth);
+        const double notes = timeNotes(synth);
+        printf("%-8s  %9.1f   %13.1f\n", setup.name, render, notes);
+    }
+    return 0;
+}
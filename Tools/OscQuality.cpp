@@ -0,0 +1,405 @@
+/*
+  ==============================================================================
+
+    OscQuality.cpp
+    Created: 19 Oct 2026 4:31:44am
+    Author:  Alexis ZBIK
+
+    Measures the oscillators across the playable range : aliasing, SNR and
+    DC from a windowed FFT, next to what each implementation costs. The
+    candidates are the naive and PolyBLEP DaisySP oscillators, PolyBLEP
+    oversampled 2x and 4x, and SynthOsc as shipped (supersaw, saw, square,
+    narrowest PWM). Every partial that isn't a harmonic of the played
+    frequencies below Nyquist counts as aliasing.
+
+    Usage : OscQuality [--from note] [--to note] [--step semitones]
+                       [--bar dB] [--csv file]
+
+    --bar picks the cheapest candidate whose worst SNR over the sweep
+    reaches the given level, for each shape. --csv writes every point
+    (cost, SNR, aliasing, DC per pitch) for plotting.
+
+  ==============================================================================
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_TSC 1
+#else
+#define HAS_TSC 0
+#endif
+
+#include "SynthOsc.h"
+
+static constexpr float sampleRate = 48000;
+static constexpr int fftSize = 1 << 16;          // 0.73 Hz bins, room between the harmonics of the lowest notes
+static constexpr int warmupFrames = 4096;
+static constexpr int harmonicHalfWidth = 6;      // Bins kept around each harmonic, the window main lobe is 4
+static constexpr float aliasBand = 12000.f;      // Aliasing below this is what's clearly heard
+
+//==============================================================================
+// Shapes and candidates
+
+struct Shape {
+    const char* name;
+    float synthOscValue;   // Position on the SynthOsc waveform knob
+    bool square;
+    float pulseWidth;
+    bool singleOsc;        // Has a single oscillator equivalent
+};
+
+static const Shape shapes[] = {
+    { "supersaw", 0.f,    false, 0.5f,  false },
+    { "saw",      0.25f,  false, 0.5f,  true },
+    { "square",   0.667f, true,  0.5f,  true },
+    { "pwm 0.03", 1.f,    true,  0.03f, true },
+};
+
+struct Candidate {
+    const char* name;
+    bool synthOsc;
+    bool polyBlep;
+    int oversampling;
+};
+
+static const Candidate candidates[] = {
+    { "naive",          false, false, 1 },
+    { "naive 4x",       false, false, 4 },
+    { "polyblep",       false, true,  1 },
+    { "polyblep 2x",    false, true,  2 },
+    { "polyblep 4x",    false, true,  4 },
+    { "SynthOsc",       true,  true,  1 },
+};
+
+// One DaisySP oscillator, optionally run at a multiple of the rate and
+// brought back down with a windowed sinc
+class SingleOsc {
+public:
+    SingleOsc(const Shape& shape, const Candidate& candidate) {
+        factor = candidate.oversampling;
+        osc.Init(sampleRate * factor);
+        osc.SetAmp(1.f);
+        if (shape.square) {
+            osc.SetWaveform(candidate.polyBlep ? Oscillator::WAVE_POLYBLEP_SQUARE : Oscillator::WAVE_SQUARE);
+        } else {
+            osc.SetWaveform(candidate.polyBlep ? Oscillator::WAVE_POLYBLEP_SAW : Oscillator::WAVE_SAW);
+        }
+        osc.SetPw(shape.pulseWidth);
+
+        if (factor > 1) {
+            const int length = 24 * factor + 1;
+            const double cutoff = 0.46 / factor; // Cycles per oversampled frame
+            taps.resize(length);
+            double sum = 0.;
+            for (int i = 0; i < length; i++) {
+                const double x = i - (length - 1) * 0.5;
+                const double sinc = x == 0. ? 2. * cutoff : sin(2. * M_PI * cutoff * x) / (M_PI * x);
+                const double phase = 2. * M_PI * i / (length - 1);
+                const double blackman = 0.42 - 0.5 * cos(phase) + 0.08 * cos(2. * phase);
+                taps[i] = (float)(sinc * blackman);
+                sum += taps[i];
+            }
+            for (float& tap : taps) {
+                tap /= sum;
+            }
+            history.assign(2 * length, 0.f);
+        }
+    }
+
+    void setFreq(float freq) {
+        osc.SetFreq(freq);
+    }
+
+    inline float process() {
+        if (factor == 1) {
+            return osc.Process();
+        }
+        const int length = (int)taps.size();
+        for (int k = 0; k < factor; k++) {
+            const float in = osc.Process();
+            history[position] = in;
+            history[position + length] = in;
+            position = position + 1 == length ? 0 : position + 1;
+        }
+        // history[position...] is the window, oldest first
+        const float* window = &history[position];
+        float out = 0.f;
+        for (int i = 0; i < length; i++) {
+            out += taps[i] * window[i];
+        }
+        return out;
+    }
+
+private:
+    Oscillator osc;
+    int factor = 1;
+    std::vector<float> taps;
+    std::vector<float> history;
+    int position = 0;
+};
+
+//==============================================================================
+// Analysis
+
+struct Metrics {
+    double snr;     // Harmonics over everything else, dB
+    double alias;   // Everything else below aliasBand, relative to the harmonics, dB
+    double dc;      // Mean, full scale
+};
+
+static void fft(std::vector<std::complex<double>>& data) {
+    const size_t n = data.size();
+    for (size_t i = 1, j = 0; i < n; i++) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+    }
+    for (size_t length = 2; length <= n; length <<= 1) {
+        const std::complex<double> step = std::polar(1., -2. * M_PI / length);
+        for (size_t i = 0; i < n; i += length) {
+            std::complex<double> w(1.);
+            for (size_t k = 0; k < length / 2; k++) {
+                const std::complex<double> a = data[i + k];
+                const std::complex<double> b = data[i + k + length / 2] * w;
+                data[i + k] = a + b;
+                data[i + k + length / 2] = a - b;
+                w *= step;
+            }
+        }
+    }
+}
+
+static Metrics analyse(const std::vector<float>& signal, const std::vector<float>& fundamentals) {
+    // 4 term Blackman-Harris, side lobes under -92 dB
+    std::vector<std::complex<double>> spectrum(fftSize);
+    double windowSum = 0.;
+    for (int i = 0; i < fftSize; i++) {
+        const double phase = 2. * M_PI * i / fftSize;
+        const double w = 0.35875 - 0.48829 * cos(phase) + 0.14128 * cos(2. * phase) - 0.01168 * cos(3. * phase);
+        spectrum[i] = signal[i] * w;
+        windowSum += w;
+    }
+    fft(spectrum);
+
+    const int binCount = fftSize / 2;
+    const double binHz = sampleRate / fftSize;
+    std::vector<bool> harmonic(binCount, false);
+    for (float f0 : fundamentals) {
+        for (double f = f0; f < sampleRate * 0.5; f += f0) {
+            const int center = (int)lround(f / binHz);
+            for (int bin = center - harmonicHalfWidth; bin <= center + harmonicHalfWidth; bin++) {
+                if (bin >= 0 && bin < binCount) {
+                    harmonic[bin] = true;
+                }
+            }
+        }
+    }
+
+    double signalEnergy = 0., noiseEnergy = 0., bandNoiseEnergy = 0.;
+    for (int bin = harmonicHalfWidth + 1; bin < binCount; bin++) {
+        const double energy = std::norm(spectrum[bin]);
+        if (harmonic[bin]) {
+            signalEnergy += energy;
+        } else {
+            noiseEnergy += energy;
+            if (bin * binHz < aliasBand) {
+                bandNoiseEnergy += energy;
+            }
+        }
+    }
+    const double floor = 1e-30;
+    return {
+        10. * log10((signalEnergy + floor) / (noiseEnergy + floor)),
+        10. * log10((bandNoiseEnergy + floor) / (signalEnergy + floor)),
+        spectrum[0].real() / windowSum
+    };
+}
+
+//==============================================================================
+// Rendering, timed
+
+struct Render {
+    std::vector<float> signal;
+    std::vector<float> fundamentals;
+    double ns;
+    double cycles;
+};
+
+static inline uint64_t readCycles() {
+#if HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+template <typename Osc>
+static void renderTimed(Osc& osc, Render& render) {
+    for (int i = 0; i < warmupFrames; i++) {
+        osc.process();
+    }
+    render.signal.resize(fftSize);
+    const uint64_t startCycles = readCycles();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < fftSize; i++) {
+        render.signal[i] = osc.process();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    render.cycles = (double)(readCycles() - startCycles) / fftSize;
+    render.ns = elapsed.count() / fftSize;
+}
+
+static Render render(const Shape& shape, const Candidate& candidate, float pitch) {
+    Render result;
+    if (candidate.synthOsc) {
+        SynthOsc osc;
+        osc.init(sampleRate);
+        osc.setWaveform(shape.synthOscValue);
+        osc.setPitch(pitch);
+        renderTimed(osc, result);
+
+        // Same detune as SynthOsc::setWaveform / setPitch
+        const float base = fminf(shape.synthOscValue * 4.f, 1.f);
+        const float detune = (1.f - base) * (1.f - base);
+        result.fundamentals.push_back(fast_mtof(pitch - detune * 0.2f));
+        if (detune > 0.f) {
+            result.fundamentals.push_back(fast_mtof(pitch + detune * 0.2f));
+        }
+    } else {
+        SingleOsc osc(shape, candidate);
+        osc.setFreq(fast_mtof(pitch));
+        renderTimed(osc, result);
+        result.fundamentals.push_back(fast_mtof(pitch));
+    }
+    return result;
+}
+
+//==============================================================================
+
+struct Summary {
+    const Shape* shape;
+    const Candidate* candidate;
+    double ns = 0., cycles = 0.;
+    double worstSnr = INFINITY, worstSnrPitch = 0.;
+    double worstAlias = -INFINITY;
+    double maxDc = 0.;
+};
+
+int main(int argc, char* argv[]) {
+    float from = 24.f, to = 108.f, step = 6.f;
+    double bar = NAN;
+    const char* csvPath = nullptr;
+    for (int k = 1; k < argc; k++) {
+        if (!strcmp(argv[k], "--from") && k + 1 < argc) {
+            from = atof(argv[++k]);
+        } else if (!strcmp(argv[k], "--to") && k + 1 < argc) {
+            to = atof(argv[++k]);
+        } else if (!strcmp(argv[k], "--step") && k + 1 < argc) {
+            step = atof(argv[++k]);
+        } else if (!strcmp(argv[k], "--bar") && k + 1 < argc) {
+            bar = atof(argv[++k]);
+        } else if (!strcmp(argv[k], "--csv") && k + 1 < argc) {
+            csvPath = argv[++k];
+        } else {
+            fprintf(stderr, "Usage : OscQuality [--from note] [--to note] [--step semitones] [--bar dB] [--csv file]\n");
+            return 1;
+        }
+    }
+    if (step <= 0.f) {
+        step = 1.f;
+    }
+
+    FILE* csv = nullptr;
+    if (csvPath) {
+        csv = fopen(csvPath, "w");
+        if (!csv) {
+            fprintf(stderr, "Can't write %s\n", csvPath);
+            return 1;
+        }
+        fprintf(csv, "shape,candidate,pitch,ns_per_sample,cycles_per_sample,snr_db,alias_db,dc\n");
+    }
+
+    printf("Notes %.0f to %.0f every %.0f, %d point FFT at %.0f Hz, aliasing below %.0f Hz\n\n",
+           from, to, step, fftSize, sampleRate, aliasBand);
+
+    std::vector<Summary> summaries;
+    for (const Shape& shape : shapes) {
+        for (const Candidate& candidate : candidates) {
+            if (!candidate.synthOsc && !shape.singleOsc) {
+                continue;
+            }
+            Summary summary;
+            summary.shape = &shape;
+            summary.candidate = &candidate;
+            int points = 0;
+            // Notes land a little off the semitone so harmonics don't sit on bins or fold onto each other
+            for (float pitch = from + 0.13f; pitch <= to + 0.13f; pitch += step) {
+                const Render result = render(shape, candidate, pitch);
+                const Metrics metrics = analyse(result.signal, result.fundamentals);
+                summary.ns += result.ns;
+                summary.cycles += result.cycles;
+                if (metrics.snr < summary.worstSnr) {
+                    summary.worstSnr = metrics.snr;
+                    summary.worstSnrPitch = pitch;
+                }
+                summary.worstAlias = fmax(summary.worstAlias, metrics.alias);
+                summary.maxDc = fmax(summary.maxDc, fabs(metrics.dc));
+                points++;
+                if (csv) {
+                    fprintf(csv, "%s,%s,%.2f,%.3f,%.1f,%.2f,%.2f,%.5f\n", shape.name, candidate.name, pitch,
+                            result.ns, result.cycles, metrics.snr, metrics.alias, metrics.dc);
+                }
+            }
+            summary.ns /= points;
+            summary.cycles /= points;
+            summaries.push_back(summary);
+        }
+    }
+    if (csv) {
+        fclose(csv);
+    }
+
+    // Sorted by cost within each shape : reading down a shape is the quality / cost curve
+    for (const Shape& shape : shapes) {
+        printf("%s\n", shape.name);
+        printf("  %-14s %9s %10s %10s %10s %9s   (worst over the sweep)\n", "candidate", "ns/smp", "cyc/smp", "SNR dB", "alias dB", "|DC|");
+        std::vector<const Summary*> rows;
+        for (const Summary& summary : summaries) {
+            if (summary.shape == &shape) {
+                rows.push_back(&summary);
+            }
+        }
+        std::sort(rows.begin(), rows.end(), [](const Summary* a, const Summary* b) { return a->ns < b->ns; });
+        const Summary* cheapest = nullptr;
+        for (const Summary* row : rows) {
+            printf("  %-14s %9.2f %10.1f %10.1f %10.1f %9.4f   SNR worst at note %.0f\n",
+                   row->candidate->name, row->ns, HAS_TSC ? row->cycles : NAN, row->worstSnr, row->worstAlias, row->maxDc, row->worstSnrPitch);
+            if (!cheapest && row->worstSnr >= bar) {
+                cheapest = row;
+            }
+        }
+        if (!std::isnan(bar)) {
+            if (cheapest) {
+                printf("  -> %s is the cheapest at %.0f dB SNR or better\n", cheapest->candidate->name, bar);
+            } else {
+                printf("  -> nothing reaches %.0f dB SNR\n", bar);
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+    Created: 19 Oct 2026 4:04:31am
+    Author:  Alexis ZBIK
+
+    Linux only. Interposes the allocator (aligned forms included) and the
+    pthread mutex, condition, rwlock and semaphore waits, which are forbidden
+    while the calling thread is inside a REALTIME_SCOPE.
+
+  ==============================================================================
+*/
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "RealtimeCheck.h"
+
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* ptr, size_t size);
+    void __libc_free(void* ptr);
+    void* __libc_memalign(size_t alignment, size_t size);
+}
+
+static thread_local int realtimeDepth = 0;
+
+namespace realtime {
+    void enter() {
+        realtimeDepth++;
+    }
+    
+    void leave() {
+        realtimeDepth--;
+    }
+}
+
+[[noreturn]] static void violation(const char* what) {
+    realtimeDepth = 0; // backtrace may allocate
+    
+    const char* header = "\n*** Real-time violation in the audio callback : ";
+    write(STDERR_FILENO, header, strlen(header));
+    write(STDERR_FILENO, what, strlen(what));
+    write(STDERR_FILENO, "\n", 1);
+    
+    void* frames[64];
+    int frameCount = backtrace(frames, 64);
+    backtrace_symbols_fd(frames, frameCount, STDERR_FILENO);
+    abort();
+}
+
+static inline void check(const char* what) {
+    if (realtimeDepth > 0) {
+        violation(what);
+    }
+}
+
+template <typename Function>
+static Function next(const char* name) {
+    return reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+}
+
+//==============================================================================
+extern "C" {
+
+void* malloc(size_t size) {
+    check("malloc");
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    check("calloc");
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    check("realloc");
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    if (ptr) {
+        check("free");
+    }
+    __libc_free(ptr);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    check("posix_memalign");
+    static auto real = next<int (*)(void**, size_t, size_t)>("posix_memalign");
+    return real(ptr, alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    check("aligned_alloc");
+    return __libc_memalign(alignment, size);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    check("memalign");
+    return __libc_memalign(alignment, size);
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    check("pthread_mutex_lock");
+    static auto real = next<int (*)(pthread_mutex_t*)>("pthread_mutex_lock");
+    return real(mutex);
+}
+
+int pthread_mutex_trylock(pthread_mutex_t* mutex) {
+    check("pthread_mutex_trylock");
+    static auto real = next<int (*)(pthread_mutex_t*)>("pthread_mutex_trylock");
+    return real(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    check("pthread_cond_wait");
+    static auto real = next<int (*)(pthread_cond_t*, pthread_mutex_t*)>("pthread_cond_wait");
+    return real(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* time) {
+    check("pthread_cond_timedwait");
+    static auto real = next<int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*)>("pthread_cond_timedwait");
+    return real(cond, mutex, time);
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* lock) {
+    check("pthread_rwlock_rdlock");
+    static auto real = next<int (*)(pthread_rwlock_t*)>("pthread_rwlock_rdlock");
+    return real(lock);
+}
+
+int pthread_rwlock_tryrdlock(pthread_rwlock_t* lock) {
+    check("pthread_rwlock_tryrdlock");
+    static auto real = next<int (*)(pthread_rwlock_t*)>("pthread_rwlock_tryrdlock");
+    return real(lock);
+}
+
+int pthread_rwlock_timedrdlock(pthread_rwlock_t* lock, const struct timespec* time) {
+    check("pthread_rwlock_timedrdlock");
+    static auto real = next<int (*)(pthread_rwlock_t*, const struct timespec*)>("pthread_rwlock_timedrdlock");
+    return real(lock, time);
+}
+
+int pthread_rwlock_wrlock(pthread_rwlock_t* lock) {
+    check("pthread_rwlock_wrlock");
+    static auto real = next<int (*)(pthread_rwlock_t*)>("pthread_rwlock_wrlock");
+    return real(lock);
+}
+
+int pthread_rwlock_trywrlock(pthread_rwlock_t* lock) {
+    check("pthread_rwlock_trywrlock");
+    static auto real = next<int (*)(pthread_rwlock_t*)>("pthread_rwlock_trywrlock");
+    return real(lock);
+}
+
+int pthread_rwlock_timedwrlock(pthread_rwlock_t* lock, const struct timespec* time) {
+    check("pthread_rwlock_timedwrlock");
+    static auto real = next<int (*)(pthread_rwlock_t*, const struct timespec*)>("pthread_rwlock_timedwrlock");
+    return real(lock, time);
+}
+
+int sem_wait(sem_t* semaphore) {
+    check("sem_wait");
+    static auto real = next<int (*)(sem_t*)>("sem_wait");
+    return real(semaphore);
+}
+
+int sem_timedwait(sem_t* semaphore, const struct timespec* time) {
+    check("sem_timedwait");
+    static auto real = next<int (*)(sem_t*, const struct timespec*)>("sem_timedwait");
+    return real(semaphore, time);
+}
+
+}
+
+//==============================================================================
+void* operator new(size_t size) {
+    check("operator new");
+    if (void* ptr = __libc_malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    check("operator new[]");
+    if (void* ptr = __libc_malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    if (ptr) {
+        check("operator delete");
+    }
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    if (ptr) {
+        check("operator delete[]");
+    }
+    __libc_free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    operator delete[](ptr);
+}
+
+// Over-aligned types (alignas above 16)
+void* operator new(size_t size, std::align_val_t alignment) {
+    check("operator new (aligned)");
+    if (void* ptr = __libc_memalign((size_t)alignment, size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    check("operator new[] (aligned)");
+    if (void* ptr = __libc_memalign((size_t)alignment, size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    if (ptr) {
+        check("operator delete (aligned)");
+    }
+    __libc_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    if (ptr) {
+        check("operator delete[] (aligned)");
+    }
+    __libc_free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept {
+    operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept {
+    operator delete[](ptr, alignment);
+}
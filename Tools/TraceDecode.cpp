@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    TraceDecode.cpp
+    Created: 19 Oct 2026 4:06:22am
+    Author:  Alexis ZBIK
+
+    Turns an EventTrace dump into a timeline. Reads either the USB serial log
+    of the hardware (TRACE BEGIN / hex lines / TRACE END, the last dump wins)
+    or a binary file written by a host build.
+
+    Usage : TraceDecode dump
+
+  ==============================================================================
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "EventTrace.h"
+
+static const char* eventNames[Trace_Count] = {
+    "block start", "block end", "OVERRUN", "note on", "note off",
+    "voice alloc", "voice steal", "play mode", "preset load"
+};
+
+static const char* playModeNames[] = { "Mono", "Unison", "Poly" };
+
+static bool readSerialLog(const char* path, std::vector<TraceEvent>& events) {
+    std::ifstream file(path);
+    std::string line;
+    bool inDump = false;
+    bool found = false;
+    while (std::getline(file, line)) {
+        if (line.compare(0, 11, "TRACE BEGIN") == 0) {
+            events.clear();
+            inDump = true;
+            found = true;
+        } else if (line.compare(0, 9, "TRACE END") == 0) {
+            inDump = false;
+        } else if (inDump && line.size() >= 16) {
+            TraceEvent e;
+            unsigned long time;
+            unsigned int type, a, b;
+            if (sscanf(line.c_str(), "%8lx%2x%2x%4x", &time, &type, &a, &b) == 4) {
+                e.time = time;
+                e.type = type;
+                e.a = a;
+                e.b = b;
+                events.push_back(e);
+            }
+        }
+    }
+    return found;
+}
+
+static void readBinary(const char* path, std::vector<TraceEvent>& events) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return;
+    }
+    TraceEvent e;
+    while (fread(&e, sizeof(TraceEvent), 1, file) == 1) {
+        events.push_back(e);
+    }
+    fclose(file);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Usage : TraceDecode dump\n");
+        return 1;
+    }
+
+    std::vector<TraceEvent> events;
+    if (!readSerialLog(argv[1], events)) {
+        readBinary(argv[1], events);
+    }
+    if (events.empty()) {
+        printf("No trace events in %s\n", argv[1]);
+        return 1;
+    }
+
+    const uint32_t origin = events.front().time;
+    uint32_t previous = origin;
+    unsigned int blockCount = 0, overrunCount = 0, noteCount = 0, stealCount = 0;
+    unsigned int worstBlock = 0;
+
+    printf("    time us    delta   event\n");
+    for (const TraceEvent& e : events) {
+        if (e.type >= Trace_Count) {
+            continue;
+        }
+        printf("%11u %8u   %-12s", e.time - origin, e.time - previous, eventNames[e.type]);
+        previous = e.time;
+
+        switch (e.type) {
+            case Trace_BlockStart:  printf(" %u frames", e.b); break;
+            case Trace_BlockEnd:
+                printf(" %u us", e.b);
+                blockCount++;
+                worstBlock = e.b > worstBlock ? e.b : worstBlock;
+                break;
+            case Trace_Overrun:     printf(" %u us", e.b); overrunCount++; break;
+            case Trace_NoteOn:      printf(" pitch %u vel %u", e.a, e.b); noteCount++; break;
+            case Trace_NoteOff:     printf(" pitch %u", e.a); break;
+            case Trace_VoiceAlloc:  printf(" voice %u pitch %u", e.a, e.b); break;
+            case Trace_VoiceSteal:  printf(" voice %u pitch %u", e.a, e.b); stealCount++; break;
+            case Trace_PlayMode:    printf(" %s", e.a < 3 ? playModeNames[e.a] : "?"); break;
+            case Trace_PresetLoad:  printf(" %u parameters changed", e.b); break;
+            default: break;
+        }
+        printf("\n");
+    }
+
+    printf("\n%zu events, %u blocks (worst %u us), %u overruns, %u notes, %u steals\n",
+           events.size(), blockCount, worstBlock, overrunCount, noteCount, stealCount);
+    return 0;
+}
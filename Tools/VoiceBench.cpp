@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    VoiceBench.cpp
+    Created: 19 Oct 2026 4:02:43am
+    Author:  Alexis ZBIK
+
+    Times PolySynth::process single threaded against the voice worker pool
+    for a growing number of active voices, to find where threading pays off.
+    Built with VOICE_COUNT=64 and POLYSYNTH_THREADS=1 (see Makefile).
+
+    Usage : VoiceBench [--threads n]
+
+  ==============================================================================
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "PolySynth.h"
+
+static constexpr double sampleRate = 48000;
+static constexpr int blockSize = 64;
+static constexpr int blockCount = 4000;
+
+static double timeBlocks(PolySynth& synth) {
+    float left[blockSize], right[blockSize];
+    float pitchLfo[blockSize] = {}, filterLfo[blockSize] = {};
+
+    auto start = std::chrono::steady_clock::now();
+    for (int block = 0; block < blockCount; block++) {
+        synth.process(left, right, pitchLfo, filterLfo, blockSize);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / blockCount;
+}
+
+int main(int argc, char* argv[]) {
+    int threadCount = (int)std::thread::hardware_concurrency();
+    for (int k = 1; k < argc; k++) {
+        if (!strcmp(argv[k], "--threads") && k + 1 < argc) {
+            threadCount = atoi(argv[++k]);
+        }
+    }
+
+    const double budget = blockSize / sampleRate * 1e6;
+    printf("%d voices max, %d threads, block %d (%.0f us budget)\n\n", VOICE_COUNT, threadCount, blockSize, budget);
+    printf("voices   single us   threaded us   speedup\n");
+
+    int crossover = -1;
+    for (int voiceCount = 1; voiceCount <= VOICE_COUNT; voiceCount *= 2) {
+        double results[2];
+        for (int threaded = 0; threaded < 2; threaded++) {
+            PolySynth synth;
+            synth.init(sampleRate);
+            synth.setPolyMode(PolySynth::Poly);
+            synth.setThreadCount(threaded ? threadCount : 1);
+            synth.setThreadingThreshold(0);
+            for (int k = 0; k < voiceCount; k++) {
+                synth.setNote(true, Note(36 + k, 100, k));
+            }
+            results[threaded] = timeBlocks(synth);
+        }
+        const double speedup = results[0] / results[1];
+        if (crossover < 0 && speedup > 1.0) {
+            crossover = voiceCount;
+        }
+        printf("%6d   %9.1f   %11.1f   x%.2f\n", voiceCount, results[0], results[1], speedup);
+    }
+
+    if (crossover > 0) {
+        printf("\nThreading wins from %d active voices : use setThreadingThreshold(%d)\n", crossover, crossover);
+    } else {
+        printf("\nThreading never wins on this machine\n");
+    }
+    return 0;
+}